@@ -21,6 +21,11 @@
 #include <stdio.h>
 #include <ctype.h>
 
+// Builds for a desktop host (e.g. the arduino_ci unit test runner) instead of a board
+#if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
+#define HOSTED_BUILD
+#endif
+
 typedef uint8_t Color;
 typedef uint8_t Piece;
 typedef uint8_t Bool;
@@ -42,6 +47,8 @@ enum {
 
     MAX_REPS = 3,    // Max number of times a pair of moves can be repeated
 
+    MAX_PLY = 7,    // The deepest ply level. game.ply is 3 bits and game.undo[] has 8 entries
+
     MAX_PIECES = 32,    // Max number of pieces in game.pieces[]
 
     NUM_BITS_PT = 4,    // Bits per field in point_t struct
@@ -92,6 +99,138 @@ enum print_t : uint8_t {
 // macro to enable the gathering of memory statistics at different ply levels
 // #define ENA_MEM_STATS
 
+// macro to enable checking the incremental game.hash against a full recalculation
+// #define ENA_HASH_CHECK
+
+// macro to enable checking the incremental game.eval totals against a full recalculation
+// #define ENA_EVAL_CHECK
+
+// macro to enable checking the game.pieces[] list and game.piece_map[] against the
+// board after every turn
+// #define ENA_PIECE_CHECK
+
+// The number of entries in the transposition table. This must be a power of 2.
+// Define TT_ENTRIES on the compiler command line to override the default size.
+#ifndef TT_ENTRIES
+#if defined(__AVR__)
+#define TT_ENTRIES 16           // 192 bytes of precious AVR RAM
+#elif defined(HOSTED_BUILD)
+#define TT_ENTRIES 131072       // 1.5 MB on a desktop host
+#else
+#define TT_ENTRIES 1024         // 12 KB on the ARM and ESP32 boards
+#endif
+#endif
+
+// The number of plies kept in the principal variation table
+#ifndef PV_PLIES
+#if defined(__AVR__)
+#define PV_PLIES 4
+#else
+#define PV_PLIES 16
+#endif
+#endif
+
+// The number of captures, promotions, killer moves and quiet moves with a history
+// that are sorted at each ply before they are searched. Any more than this are
+// searched along with the rest of the quiet moves.
+#ifndef MAX_ORDERED
+#if defined(__AVR__)
+#define MAX_ORDERED 8
+#else
+#define MAX_ORDERED 32
+#endif
+#endif
+
+// The number of moves in the move stack that the moves for every ply being
+// searched are generated into with ENA_MOVE_LIST. A ply's moves that don't fit
+// are searched after the moves that did, without being ordered.
+#ifndef MOVE_STACK
+#if defined(HOSTED_BUILD)
+#define MOVE_STACK 4096         // 16 KB on a desktop host
+#else
+#define MOVE_STACK 512          // 2 KB on the ARM and ESP32 boards
+#endif
+#endif
+
+// The number of moves the benchmark plays from the starting position and the ply
+// depth it searches them to. The moves played are always the same so the moves
+// per second can be compared between builds.
+#ifndef BENCH_MOVES
+#if defined(__AVR__)
+#define BENCH_MOVES 6
+#else
+#define BENCH_MOVES 30
+#endif
+#endif
+
+#ifndef BENCH_PLY
+#if defined(__AVR__)
+#define BENCH_PLY 2
+#else
+#define BENCH_PLY 4
+#endif
+#endif
+
+// macro to enable the history heuristic table used to order quiet moves.
+// The table takes 16 KB so it is left out of the AVR builds.
+#if !defined(__AVR__)
+#define ENA_HISTORY
+#endif
+
+// macro to generate each node's moves onto the move stack and search them by their
+// scores (game.options.move_list). The AVR move stack only held about two plies of
+// moves so it is left out there along with its 256 bytes of RAM.
+#if !defined(__AVR__)
+#define ENA_MOVE_LIST
+#endif
+
+// macro to use the bitboard board backend (board_t3) and the move generation and
+// evaluation that use it. The AVR builds keep the smaller board_t2.
+#if !defined(__AVR__)
+#define ENA_BITBOARD
+#endif
+
+// macro to look up the sliding piece attacks in the magic bitboard tables.
+// The tables take about 860 KB so they are only used on a desktop host.
+#if defined(ENA_BITBOARD) && defined(HOSTED_BUILD)
+#define ENA_MAGIC
+#endif
+
+// macro to let each thread run its own engine_t. The sketch only uses the default
+// engine so this is only needed on a desktop host.
+#if defined(HOSTED_BUILD)
+#define ENA_ENGINES
+#endif
+
+// macro to let more than one thread search each move using Lazy SMP. Each thread
+// searches with its own engine_t and they share the transposition table. The root
+// split generates the root moves onto the move stack.
+#if defined(ENA_ENGINES) && defined(ENA_MOVE_LIST)
+#define ENA_SMP
+#endif
+
+// The most threads that can search a move together with ENA_SMP
+#ifndef MAX_THREADS
+#define MAX_THREADS 16
+#endif
+
+// macro to play many self-play games at the same time, each on its own thread
+// with its own engine_t, and add up how they ended
+#if defined(ENA_ENGINES)
+#define ENA_SELFPLAY
+#endif
+
+// macro to let White and Black search with their own options and to play matches
+// between two sets of options. The options for each side take too much memory
+// for the ATmega328.
+#if !defined(__AVR__)
+#define ENA_MATCH
+#endif
+
+// macro to build the search with the features in fixed_config_t instead of testing
+// the game.options bits for them at every node
+// #define ENA_FIXED_CONFIG
+
 // macro to return the number of elements in an array of any data type
 #define ARRAYSZ(A) (sizeof((A)) / sizeof(*((A))))
 
@@ -101,9 +240,11 @@ enum print_t : uint8_t {
 #define getbit(_A, _B) ((char*)(_A))[(_B) / 8] &   (0x80 >> ((_B) % 8))
 
 // ---------------------------------------------------------------------
-//  MAX_VALUE / MIN_VALUE – compile‑time constants derived from LONG_MAX
+//  MAX_VALUE / MIN_VALUE – compile‑time constants derived from INT32_MAX
+//  so that they fit in move_t::value and tt_entry_t::value on hosts
+//  where a long is 64 bits (identical to LONG_MAX / 2 on the boards)
 // ---------------------------------------------------------------------
-constexpr long MAX_VALUE = LONG_MAX / 2L;   // same semantics as the original macro
+constexpr long MAX_VALUE = INT32_MAX / 2L;  // same semantics as the original macro
 constexpr long MIN_VALUE = -MAX_VALUE;      // negative of MAX_VALUE
 
 // The number of locations on the game board
@@ -183,7 +324,7 @@ extern int debug(char const * const progmem, ...);
 
 #define printf(__level, __str, ...)                                          \
     do {                                                                    \
-        if (game.options.print_level >= __level) {                           \
+        if (engine->game.options.print_level >= __level) {                   \
             static const char debug_string[] PROGMEM = __str;                \
             debug(debug_string, ##__VA_ARGS__);                             \
         }                                                                   \
@@ -215,6 +356,16 @@ enum state_t : uint8_t {
 #include "move.h"
 #include "game.h"
 #include "conv.h"
+#include "ttable.h"
+#include "pv.h"
+#include "heuristics.h"
+#include "magic.h"
+#include "movestack.h"
+#include "engine.h"
+#include "smp.h"
+#include "match.h"
+#include "selfplay.h"
+#include "config.h"
 
 // Add for non‑AVR builds
 #ifndef pgm_get_far_address
@@ -223,14 +374,10 @@ enum state_t : uint8_t {
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // A structure to represent an opening move or sequences of moves
-struct book_t {
-    uint8_t const
-        from : 6,  // the starting location
-          to : 6;  // the ending location
-
+struct book_t : public pmove_t {
     static Color const side;
 
-    book_t(index_t const f, index_t const t) : from(f), to(t) {}
+    book_t(index_t const f, index_t const t) : pmove_t(f, t) {}
 };
 
 
@@ -238,6 +385,51 @@ struct book_t {
 typedef void    (generator_t(struct piece_gen_t &gen));
 
 
+// The scores used to order the moves that are searched before the rest of the quiet moves
+enum : uint16_t {
+    ORDER_HISTORY = 0x3FFD,     // quiet moves by their history count, up to this
+    ORDER_KILLER  = 0x3FFF,     // killer moves, minus the killer slot
+    ORDER_CAPTURE = 0x4000,     // captures and promotions, plus their order_score(...)
+    ORDER_BEST    = 0x7FFF,     // the best move from the transposition table or principal variation
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+// A move waiting to be searched and the score used to order it
+struct ordered_t {
+    uint16_t from : 6,  // the starting location
+               to : 6;  // the ending location
+    uint16_t score;     // one of the ORDER_XXX scores
+
+};  // ordered_t
+
+
+// The moves for one call to choose_best_moves(...) in the order they are searched:
+// The best move from the transposition table or principal variation, then the
+// captures and promotions, the killer moves, the quiet moves with a history,
+// and then the rest of the quiet moves.
+struct order_t {
+    generator_t * callback;     // The function to call for each move being searched
+    ordered_t   moves[MAX_ORDERED];
+    index_t     count;          // The number of moves in moves[]
+    index_t     best_from;      // The move to search first or -1 if there isn't one
+    index_t     best_to;
+    Bool        best_found;     // True if the move to search first was generated
+
+};  // order_t
+
+
+// The checks and pins for the side to move. These are found once for each node
+// so that only the legal moves for the side to move are generated.
+struct legal_t {
+    uint64_t    evasions;       // The spots the pieces other than the King can move to
+    uint64_t    pinned;         // The spots of the pieces pinned to the King
+    index_t     king;           // The King's spot
+    uint8_t     side : 1,       // The side the checks and pins are for
+            checkers : 2;       // The number of pieces giving check, up to 2
+
+};  // legal_t
+
+
 // The piece_gen_t type is a parameter passing structure used
 // to speed up the move generation calls for the piece types.
 // This is the structure that is passed to each generator function
@@ -256,6 +448,17 @@ class piece_gen_t {
     // The function to call for each move to be evaluated
     generator_t * callme;
 
+    // The moves being sorted for this node when ordering moves, otherwise nullptr
+    order_t     * order;
+
+    // The checks and pins for the side to move when only legal moves are generated, otherwise nullptr
+    legal_t const * legal;
+
+    // The alpha-beta window for this node when searching with negamax.
+    // These are from the point of view of the side to move.
+    long        alpha;
+    long        beta;
+
     uint8_t
                  piece : 6,     // The Piece being moved
             evaluating : 1,     // True if we are just evaluating the move
@@ -270,7 +473,8 @@ class piece_gen_t {
                 cutoff : 1,     // True if we have reached the alpha or beta cutoff
 
             num_bmoves : 5,     // The number of white moves available
-           piece_index : 5;     // The index into the pieces list of the piece being evaluated
+           piece_index : 6,     // The index into the pieces list of the piece being evaluated
+             follow_pv : 1;     // True if the moves that led here are the last principal variation
 
     piece_gen_t(move_t &m);
 
@@ -306,18 +510,40 @@ extern Bool     check_serial();
 extern Bool     check_book();
 
 extern void     check_kings();
+extern Bool     is_square_attacked(index_t const square, Color const by_side);
+extern void     find_checks_and_pins(legal_t &legal, Color const side);
+extern Bool     is_legal(piece_gen_t const &gen);
+extern Bool     king_in_check(Color const side);
 extern void     consider_move(piece_gen_t &gen);
+extern void     consider_negamax(piece_gen_t &gen);
+extern void     collect_moves(piece_gen_t &gen);
+extern void     visit_quiet(piece_gen_t &gen);
+extern void     list_move(piece_gen_t &gen);
+extern void     collect_captures(piece_gen_t &gen);
+extern void     make(piece_gen_t &gen);
+extern void     unmake(piece_gen_t const &gen);
 extern long     make_move(piece_gen_t &gen);
 extern long     evaluate(piece_gen_t &gen);
 extern Bool     would_repeat(move_t const &move);
 extern Bool     add_to_history(move_t const &move);
-extern void     choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback);
-
-extern index_t  add_pawn_moves(piece_gen_t &gen);
-extern index_t  add_knight_moves(piece_gen_t &gen);
-extern index_t  add_bishop_moves(piece_gen_t &gen);
-extern index_t  add_rook_moves(piece_gen_t &gen);
-extern index_t  add_queen_moves(piece_gen_t &gen);
-extern index_t  add_king_moves(piece_gen_t &gen);
+extern void     choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback,
+                    long const alpha = MIN_VALUE, long const beta = MAX_VALUE);
+extern void     quiesce(move_t &wbest, move_t &bbest, long const stand_pat, long const alpha, long const beta);
+extern void     insert_ordered(order_t &order, move_t const &move, uint16_t const score);
+extern void     reset_turn_flags();
+extern void     iterative_deepening(move_t &wmove, move_t &bmove);
+extern void     search_root(move_t &wbest, move_t &bbest, Bool const split);
+extern void     search_moves(move_t &wmove, move_t &bmove);
+extern void     take_turn();
+extern void     benchmark();
+extern uint8_t  order_score(piece_gen_t const &gen);
+extern uint16_t move_score(piece_gen_t const &gen);
+extern uint8_t  move_flags(piece_gen_t const &gen);
+
+extern Bool     set_gen_piece(piece_gen_t &gen, index_t const piece_index);
+extern Bool     first_legal_move(move_t &best);
+extern void     perft_move(piece_gen_t &gen);
+extern uint32_t perft(index_t const depth);
+extern index_t  add_piece_moves(piece_gen_t &gen);
 
 #endif // MICROCHESS_INCL
@@ -61,13 +61,48 @@
 // #include <Wire.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// The game board
-board_t board;
+// The engine that the sketch plays with: the game board, the currently running game
+// states and flags, and the tables used to order the moves
+engine_t default_engine;
+
+#ifdef ENA_ENGINES
+////////////////////////////////////////////////////////////////////////////////////////
+// The engine the calling thread is using
+thread_local engine_t *engine = &default_engine;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// The results of positions we have already searched
+ttable_t ttable;
+
+
+#ifdef ENA_MAGIC
+////////////////////////////////////////////////////////////////////////////////////////
+// The sliding piece attack tables
+magic_t magic;
+#endif
+
+
+#ifdef ENA_SMP
+////////////////////////////////////////////////////////////////////////////////////////
+// The helper threads that search each move along with the main thread
+smp_t smp;
+#endif
+
+
+#ifdef ENA_MATCH
+////////////////////////////////////////////////////////////////////////////////////////
+// The match between White's options and Black's options
+match_t match;
+#endif
 
 
+#ifdef ENA_SELFPLAY
 ////////////////////////////////////////////////////////////////////////////////////////
-// The currently running game states and flags
-game_t game;
+// The threads that play the self-play games
+selfplay_t selfplay;
+#endif
 
 
 // Un-comment the following line to display each move as it is evaluated
@@ -92,24 +127,24 @@ void consider_move(piece_gen_t &gen)
 
     dont_move = False;
 
-    if (PLAYING != game.state) {
+    if (PLAYING != engine->game.state) {
         return;
     }
 
     // If this is a supplied move that has already been validated then just return:
-    if (game.supply_valid) {
+    if (engine->game.supply_valid) {
         return;
     }
 
     // See if the destination is a king, and if so then don't really make the move
     // or evaluate it; Just return MAX or MIN value depending on whose side it is:
-    if (getType(board.get(gen.move.to)) == King) {
+    if (getType(engine->board.get(gen.move.to)) == King) {
         if (gen.whites_turn) {
-            game.white_king_in_check = True;
+            engine->game.white_king_in_check = True;
             gen.move.value = MAX_VALUE;
         }
         else {
-            game.black_king_in_check = True;
+            engine->game.black_king_in_check = True;
             gen.move.value = MIN_VALUE;
         }
 
@@ -119,9 +154,9 @@ void consider_move(piece_gen_t &gen)
     }
 
     // See if the move came from the user or from an opening book:
-    if (game.book_supplied || game.user_supplied) {
-        if ((gen.move.from == game.supplied.from) && (gen.move.to == game.supplied.to)) {
-            game.supply_valid = True;
+    if (engine->game.book_supplied || engine->game.user_supplied) {
+        if ((gen.move.from == engine->game.supplied.from) && (gen.move.to == engine->game.supplied.to)) {
+            engine->game.supply_valid = True;
             return;
         }
     }
@@ -129,7 +164,7 @@ void consider_move(piece_gen_t &gen)
     // Check for alpha or beta cutoff
     if (gen.cutoff) {
         #ifdef SHOW1
-        if (0 == game.ply) {
+        if (0 == engine->game.ply) {
             printf(Debug1, "** ");
         }
         #endif
@@ -139,6 +174,11 @@ void consider_move(piece_gen_t &gen)
     // Recursively generate the move's value
     if (!dont_move) {
         make_move(gen);
+
+        // Remember the quiet moves that cause a cutoff so they are searched early next time
+        if (gen.cutoff && engine->game.options.quiet_order && (0 == order_score(gen))) {
+            engine->heuristics.update(gen.side, engine->game.ply, engine->game.options.maxply - engine->game.ply, gen.move);
+        }
     }
 
     if (Pawn == gen.piece) {
@@ -147,7 +187,7 @@ void consider_move(piece_gen_t &gen)
     }
 
     // See if we are in the end game
-    if (game.piece_count <= END_COUNT) {
+    if (engine->game.piece_count <= END_COUNT) {
         if (Pawn == gen.piece) {
             // Reward any moves involving a Pawn at this point
             gen.move.value += (gen.whites_turn ? +5000 : -5000);
@@ -156,7 +196,7 @@ void consider_move(piece_gen_t &gen)
             // Otherwise make all pieces converge on the opponent's King.
 
             // Get the location of the opponent's King
-            index_t kingloc = (gen.whites_turn ? game.bking : game.wking);
+            index_t kingloc = (gen.whites_turn ? engine->game.bking : engine->game.wking);
             index_t king_col = kingloc % 8;
             index_t king_row = kingloc / 8;
 
@@ -165,15 +205,15 @@ void consider_move(piece_gen_t &gen)
             index_t delta_row = abs((gen.move.to / 8) - king_row);
 
             gen.move.value = (14 - (delta_col + delta_row)) + 
-                (gen.whites_turn ? game.black_king_in_check : game.white_king_in_check) * 10;
+                (gen.whites_turn ? engine->game.black_king_in_check : engine->game.white_king_in_check) * 10;
         }
     }
 
-    if (gen.whites_turn && game.white_king_in_check) {
+    if (gen.whites_turn && engine->game.white_king_in_check) {
         gen.move.value = MIN_VALUE;
     }
     
-    if (!gen.whites_turn && game.black_king_in_check) {
+    if (!gen.whites_turn && engine->game.black_king_in_check) {
         gen.move.value = MAX_VALUE;
     }
     
@@ -184,7 +224,7 @@ void consider_move(piece_gen_t &gen)
 
     // See if this move is equal to OR greater than the best move we've seen so far
     if (gen.whites_turn) {
-        if ((gen.move.value == gen.wbest.value) && random(2)) {
+        if ((gen.move.value == gen.wbest.value) && search_config_t::random_ties() && engine->random(2)) {
             gen.wbest = gen.move;
         }
         else if (gen.move.value > gen.wbest.value) {
@@ -192,7 +232,7 @@ void consider_move(piece_gen_t &gen)
         }
     }
     else {
-        if ((gen.move.value == gen.bbest.value) && random(2)) {
+        if ((gen.move.value == gen.bbest.value) && search_config_t::random_ties() && engine->random(2)) {
             gen.bbest = gen.move;
         }
         else if (gen.move.value < gen.bbest.value) {
@@ -202,7 +242,7 @@ void consider_move(piece_gen_t &gen)
 
     // Debugging output
     #ifdef SHOW1
-    if (0 == game.ply) {
+    if (0 == engine->game.ply) {
         show_move(gen.move, True);
     }
     #endif
@@ -211,160 +251,189 @@ void consider_move(piece_gen_t &gen)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// Move a piece on the board, taking a piece if necessary. Evaluate the value of the 
-// board after the move. Optionally restore the board back to it's original state after
-// evaluating the value of the move.
-// 
-// This is a big and complicated function.
-// It performs 5 major steps:
-// 
-//  1) Identify the piece being moved
-//  2) Identify any piece being captured and remove it if so
-//  3) Place the piece being moved at the destination
-//  4) Evaluate the board score after making the move
-//  5) If we are just considering the move then put everything back
-// 
-// returns the value of the board after the move was made
-// 
+// Consider a move for the side to move when searching with negamax. The move values
+// are from the point of view of the side making the move, so the best move is always
+// the one with the highest value, and the node's alpha-beta window is kept in the
+// piece_gen_t instead of in game.alpha and game.beta.
+//
 // Note: Sanitized stack
-long make_move(piece_gen_t & gen)
+void consider_negamax(piece_gen_t &gen)
 {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
-    struct local_t {
-        uint8_t
-                                 op : 6,
-                      book_supplied : 1,
-                      user_supplied : 1,    //  8
-
-                         board_rook : 6,
-            last_was_pawn_promotion : 1,
-                last_was_en_passant : 1,    // 16
-
-                        place_piece : 6,
-                white_king_in_check : 1,
-                black_king_in_check : 1,    // 24
-
-                     captured_piece : 6,
-                    last_was_castle : 1,
-                          quiescent : 1,    // 32
-
-                             to_col : 3,
-                       supply_valid : 1,
-                             to_row : 3,
-                              oside : 1,    // 40
-
-                              wking : 6,
-                              bking : 6,
-                  white_taken_count : 5, 
-                  black_taken_count : 5,
-                              otype : 3;    // 65 bits (9 bytes)
-    } vars;
-
-    index_t taken_index, captured, castly_rook, hist_count;
-    game_t::history_t history[MAX_REPS * 2 - 1];
-    move_t  last_move, wbest, bbest;
-    int32_t recurse_value;
+    move_t &best = gen.whites_turn ? gen.wbest : gen.bbest;
 
     //  Check for low stack space
-    if (check_mem(MAKE)) { return gen.whites_turn ? MIN_VALUE : MAX_VALUE; }
+    if (check_mem(CONSIDER)) { return; }
 
-    // Now we can alter local variables! 😎 
+    if ((PLAYING != engine->game.state) || engine->game.supply_valid || gen.cutoff) {
+        return;
+    }
 
-    // The value of the board.
-    // Default to the worst value for our side.
-    // i.e: Don't make the move whatever it is
-    gen.move.value = gen.whites_turn ? MIN_VALUE : MAX_VALUE;
+    // If we can take the King then the move that got us here left it in check
+    // and wasn't legal. The side that made it gets the worst value for it.
+    if (King == getType(engine->board.get(gen.move.to))) {
+        gen.move.value = MAX_VALUE;
+        best = gen.move;
+        gen.cutoff = True;
+        return;
+    }
+
+    // See if the move came from the user or from an opening book:
+    if (engine->game.book_supplied || engine->game.user_supplied) {
+        if ((gen.move.from == engine->game.supplied.from) && (gen.move.to == engine->game.supplied.to)) {
+            engine->game.supply_valid = True;
+            return;
+        }
+    }
+
+    // Recursively generate the move's value. The next ply's line in the principal
+    // variation is emptied first since it isn't set unless we search below this move.
+    engine->pv.clear(engine->game.ply + 1);
+    make_move(gen);
+
+    // Moves that would lose the game by repetition are still better than illegal moves
+    if ((0 == engine->game.ply) && would_repeat(gen.move)) {
+        gen.move.value = MIN_VALUE + 1;
+    }
+
+    // See if this is the best move so far. Equal moves can be chosen at random at the root.
+    if ((-1 == best.from) || (gen.move.value > best.value) ||
+        ((0 == engine->game.ply) && (gen.move.value == best.value) && search_config_t::random_ties() && engine->random(2))) {
+        best = gen.move;
+        engine->pv.update(engine->game.ply, gen.move);
+    }
+
+    // Narrow the window and check for a beta cutoff
+    if (best.value > gen.alpha) {
+        gen.alpha = best.value;
+        if (search_config_t::alpha_beta_pruning() && (gen.alpha >= gen.beta)) {
+            gen.cutoff = True;
+
+            // Remember the quiet moves that cause a cutoff so they are searched early next time
+            if (engine->game.options.quiet_order && (0 == order_score(gen))) {
+                engine->heuristics.update(gen.side, engine->game.ply, engine->game.options.maxply - engine->game.ply, gen.move);
+            }
+        }
+    }
+
+    // Debugging output
+    #ifdef SHOW1
+    if (0 == engine->game.ply) {
+        show_move(gen.move, True);
+    }
+    #endif
+
+}   // consider_negamax(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Make a move on the board, taking a piece if necessary, and update the piece list,
+// the hash and the evaluation totals to match. Everything that unmake(...) needs to
+// put the game back is saved in game.undo[game.ply] first.
+//
+// This performs steps 1 to 3 of make_move(...):
+//
+//  1) Identify the piece being moved
+//  2) Identify any piece being captured and remove it if so
+//  3) Place the piece being moved at the destination
+//
+// Note: Sanitized stack
+void make(piece_gen_t &gen)
+{
+    // Stack Management
+    // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
+    // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
+    game_t::undo_t &undo = engine->game.undo[engine->game.ply];
+    uint64_t state;
+    index_t to_col, rook_from, rook_to;
+    Piece place_piece, rook;
+    #ifdef ENA_EVAL_CHECK
+    game_t::eval_t eval_check;
+    #endif
 
+    // make_move(...) has already checked for low stack space
 
     /// Step 1: Identify the piece being moved
 
-    vars.to_col = uint8_t(gen.move.to % 8);
-    vars.to_row = uint8_t(gen.move.to / 8);
-    vars.op = board.get(gen.move.to);
-    vars.otype = getType(vars.op);
-    vars.oside = getSide(vars.op);        
+    to_col = gen.move.to % 8;
+    undo.op = engine->board.get(gen.move.to);
 
-    // Save the current last 5 moves in the game history
-    hist_count = game.hist_count;
+    // Save the hash, the evaluation totals and the last move
+    undo.hash = engine->game.hash;
+    undo.eval = engine->game.eval;
+    undo.last_move = engine->game.last_move;
 
     // Save the current king locations
-    vars.wking = game.wking;
-    vars.bking = game.bking;
+    undo.wking = engine->game.wking;
+    undo.bking = engine->game.bking;
 
     // Save the current number of taken pieces
-    vars.white_taken_count = game.white_taken_count;
-    vars.black_taken_count = game.black_taken_count;
+    undo.white_taken_count = engine->game.white_taken_count;
+    undo.black_taken_count = engine->game.black_taken_count;
 
-    // Save the current last move and move flags
-    vars.last_was_pawn_promotion = game.last_was_pawn_promotion;
-    vars.last_was_en_passant = game.last_was_en_passant;
-    vars.last_was_castle = game.last_was_castle;
-    last_move = game.last_move;
+    // Save the current move flags
+    undo.last_was_pawn_promotion = engine->game.last_was_pawn_promotion;
+    undo.last_was_en_passant = engine->game.last_was_en_passant;
+    undo.last_was_castle = engine->game.last_was_castle;
 
     // Save the user supplied  and book supplied flags
-    vars.book_supplied = game.book_supplied;
-    vars.user_supplied = game.user_supplied;
-    vars.supply_valid = game.supply_valid;
-
-    if (gen.evaluating) {
-        memmove(history, game.history, sizeof(history));
-        game.stats.inc_moves_count();
-    }
+    undo.book_supplied = engine->game.book_supplied;
+    undo.user_supplied = engine->game.user_supplied;
+    undo.supply_valid = engine->game.supply_valid;
 
     // Save the state of whether or not the kings are in check.
     // We do this AFTER we've had a chance to set the 'king-in-check'
     // flags above so that this move leaves the flags behind after evaluation
-    vars.white_king_in_check = game.white_king_in_check;
-    vars.black_king_in_check = game.black_king_in_check;
+    undo.white_king_in_check = engine->game.white_king_in_check;
+    undo.black_king_in_check = engine->game.black_king_in_check;
 
+    // The castling rights and en-passant state that are part of the hash
+    state = zobrist_state(castle_rights(), en_passant_col());
 
-    /// Step 2: Identify any piece being captured and remove it if so.
-    // 
-    // * NOTE BELOW *
-    // Once any changes have been made to the board or game state we MUST NOT return
-    // without passing through the "if (gen.evaluating) { ... }" restoration logic.
 
-    // The game.pieces[] index being captured (if any, -1 if none)
-    taken_index = -1;
+    /// Step 2: Identify any piece being captured and remove it if so.
 
     // The board index being captured (if any, -1 if none)
-    captured = -1;
-    vars.captured_piece = Empty;
+    undo.captured = -1;
+    undo.captured_piece = Empty;
 
     // Check for en-passant capture
-    if (Pawn == gen.type && isEmpty(vars.otype) && gen.col != vars.to_col) {
-        game.last_was_en_passant = True;
-        captured = vars.to_col + gen.row * 8u;
-        vars.captured_piece = board.get(captured);
+    if (Pawn == gen.type && isEmpty(undo.op) && gen.col != to_col) {
+        engine->game.last_was_en_passant = True;
+        undo.captured = to_col + gen.row * 8u;
+        undo.captured_piece = engine->board.get(undo.captured);
     }
     else {
         // See if the destination is not empty and not a piece on our side.
         // i.e. an opponent's piece.
-        if (Empty != vars.otype && gen.side != vars.oside) {
-            captured = gen.move.to;
-            vars.captured_piece = board.get(captured);
+        if (!isEmpty(undo.op) && gen.side != getSide(undo.op)) {
+            undo.captured = gen.move.to;
+            undo.captured_piece = undo.op;
         }
     }
 
     // If a piece was taken, make the change on the board and to the game.pieces[] list
-    if (-1 != captured) {
+    if (-1 != undo.captured) {
         // Remember the piece index of the piece being taken
-        taken_index = game.find_piece(captured);
+        undo.taken_index = engine->game.find_piece(undo.captured);
 
         // Change the spot on the board for the taken piece to Empty
-        board.set(captured, Empty);
+        engine->board.set(undo.captured, Empty);
+        engine->game.hash ^= zobrist_piece(undo.captured_piece, undo.captured);
+        engine->game.add_eval(undo.captured_piece, undo.captured, -1);
 
         // Soft-delete the piece taken in the piece list!
-        game.pieces[taken_index] = { -1, -1 };
+        engine->game.pieces[undo.taken_index] = { -1, -1 };
+        engine->game.piece_map[undo.captured] = -1;
 
         // Add the piece to the list of taken pieces
         if (gen.whites_turn) {
-            game.taken_by_white[game.white_taken_count++].piece = vars.captured_piece;
+            engine->game.taken_by_white[engine->game.white_taken_count++].piece = undo.captured_piece;
         }
         else {
-            game.taken_by_black[game.black_taken_count++].piece = vars.captured_piece;
+            engine->game.taken_by_black[engine->game.black_taken_count++].piece = undo.captured_piece;
         }
     }
 
@@ -372,81 +441,285 @@ long make_move(piece_gen_t & gen)
     /// Step 3: Place the piece being moved at the destination
 
     // Set the 'moved' flag on the piece that we place on the board
-    vars.place_piece = setMoved(gen.piece, True);
+    place_piece = setMoved(gen.piece, True);
 
     // Promote a Pawn to a Queen if it reaches the back row
-    if (Pawn == gen.type && (vars.to_row == (gen.whites_turn ? index_t(0) : index_t(7)))) {
-        vars.place_piece = setType(vars.place_piece, Queen);
-        game.last_was_pawn_promotion = True;
+    if (Pawn == gen.type && ((gen.move.to / 8) == (gen.whites_turn ? 0 : 7))) {
+        place_piece = setType(place_piece, Queen);
+        engine->game.last_was_pawn_promotion = True;
     }
 
     // Move the piece to the destination on the board
-    board.set(gen.move.from, Empty);
-    board.set(gen.move.to, vars.place_piece);
+    engine->board.set(gen.move.from, Empty);
+    engine->board.set(gen.move.to, place_piece);
+    engine->game.hash ^= zobrist_piece(gen.piece, gen.move.from) ^ zobrist_piece(place_piece, gen.move.to);
+    engine->game.add_eval(gen.piece, gen.move.from, -1);
+    engine->game.add_eval(place_piece, gen.move.to, +1);
 
     // Update the piece list to reflect the piece's new location
-    game.pieces[gen.piece_index] = { index_t(vars.to_col), index_t(vars.to_row) };
+    engine->game.pieces[gen.piece_index] = { to_col, index_t(gen.move.to / 8) };
+    engine->game.piece_map[gen.move.from] = -1;
+    engine->game.piece_map[gen.move.to] = gen.piece_index;
 
     // Check for castling
-    castly_rook = -1;
+    undo.castly_rook = -1;
 
     // If the piece being moved is a King
     if (King == gen.type) {
         // Update this side's king location
-        ((White == gen.side) ? game.wking : game.bking) = gen.move.to;
+        ((White == gen.side) ? engine->game.wking : engine->game.bking) = gen.move.to;
 
         // Get the horizontal distance the king is
         // moving and see if it is a Castling move (king moves 2 squares)
-        if (abs(vars.to_col - (gen.move.from % 8)) == 2) {
-            // Use direction to determine which side we're castling on
-            if (vars.to_col > (gen.move.from % 8)) {
-                // Castle on the King's side (king moved right, toward h-file)
-                // Rook goes from h-file (col 7) to f-file (col 5)
-                vars.board_rook = 7 + gen.row * 8u;
-                castly_rook = game.find_piece(vars.board_rook);
-                board.set(5 + gen.row * 8u, setMoved(board.get(vars.board_rook), True));
-                board.set(vars.board_rook, Empty);
-                game.pieces[castly_rook].x = 5;
-                game.last_was_castle = True;
-            }
-            else {
-                // Castle on the Queen's side (king moved left, toward a-file)
-                // Rook goes from a-file (col 0) to d-file (col 3)
-                vars.board_rook = 0 + gen.row * 8u;
-                castly_rook = game.find_piece(vars.board_rook);
-                board.set(3 + gen.row * 8u, setMoved(board.get(vars.board_rook), True));
-                board.set(vars.board_rook, Empty);
-                game.pieces[castly_rook].x = 3;
-                game.last_was_castle = True;
-            }
+        if (abs(to_col - (gen.move.from % 8)) == 2) {
+            // Use direction to determine which side we're castling on.
+            // On the King's side (king moved right, toward h-file) the rook goes
+            // from the h-file (col 7) to the f-file (col 5). On the Queen's side
+            // (king moved left, toward a-file) it goes from the a-file (col 0)
+            // to the d-file (col 3).
+            rook_from = ((to_col > (gen.move.from % 8)) ? 7 : 0) + gen.row * 8u;
+            rook_to   = ((to_col > (gen.move.from % 8)) ? 5 : 3) + gen.row * 8u;
+            rook = engine->board.get(rook_from);
+
+            undo.castly_rook = engine->game.find_piece(rook_from);
+            engine->game.hash ^= zobrist_piece(rook, rook_from) ^ zobrist_piece(rook, rook_to);
+            engine->game.add_eval(rook, rook_from, -1);
+            engine->game.add_eval(rook, rook_to, +1);
+            engine->board.set(rook_to, setMoved(rook, True));
+            engine->board.set(rook_from, Empty);
+            engine->game.pieces[undo.castly_rook].x = rook_to % 8;
+            engine->game.piece_map[rook_from] = -1;
+            engine->game.piece_map[rook_to] = undo.castly_rook;
+            engine->game.last_was_castle = True;
         }
+
+        // Every piece on the other side is now closer to or further from our King
+        engine->game.set_proximity(engine->board);
+    }
+
+    // set our move as the last move
+    engine->game.last_move = gen.move;
+
+    // Update the hash for any change in the castling rights and en-passant state
+    engine->game.hash ^= state ^ zobrist_state(castle_rights(), en_passant_col());
+
+    #ifdef ENA_HASH_CHECK
+    if (engine->game.hash != hash_board(engine->game.turn)) {
+        printf(Always, "hash mismatch: line %d\n", __LINE__);
+    }
+    #endif
+
+    #ifdef ENA_EVAL_CHECK
+    engine->game.calc_eval(engine->board, eval_check);
+    if (memcmp(&eval_check, &engine->game.eval, sizeof(eval_check))) {
+        printf(Always, "eval mismatch: line %d\n", __LINE__);
+    }
+    #endif
+
+}   // make(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Take back the move made by make(...) at this ply using game.undo[game.ply]
+//
+// Note: Sanitized stack
+void unmake(piece_gen_t const &gen)
+{
+    // Stack Management
+    // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
+    // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
+    game_t::undo_t const &undo = engine->game.undo[engine->game.ply];
+    index_t rook_from, rook_to;
+    #ifdef ENA_EVAL_CHECK
+    game_t::eval_t eval_check;
+    #endif
+
+    // restore the destination spot. This must happen even when a piece was captured
+    // since an en-passant capture takes a piece from a different spot than the destination
+    engine->board.set(gen.move.to, undo.op);
+    engine->game.piece_map[gen.move.to] = -1;
+
+    if (-1 != undo.captured) {
+        // restore the captured board changes
+        engine->board.set(undo.captured, undo.captured_piece);
+
+        // restore the captured piece list changes
+        engine->game.pieces[undo.taken_index] = { index_t(undo.captured % 8), index_t(undo.captured / 8) };
+        engine->game.piece_map[undo.captured] = undo.taken_index;
+    }
+
+    // restore the taken pieces list changes
+    engine->game.white_taken_count = undo.white_taken_count;
+    engine->game.black_taken_count = undo.black_taken_count;
+
+    // restore the moved piece board changes
+    engine->board.set(gen.move.from, gen.piece);
+
+    // restore the moved piece pieces list changes
+    engine->game.pieces[gen.piece_index] = { index_t(gen.col), index_t(gen.row) };
+    engine->game.piece_map[gen.move.from] = gen.piece_index;
+
+    // restore any rook moved during a castle move
+    if (-1 != undo.castly_rook) {
+        rook_to = engine->game.pieces[undo.castly_rook].x + engine->game.pieces[undo.castly_rook].y * 8;
+        rook_from = ((3 == (rook_to % 8)) ? 0 : 7) + gen.row * 8;
+
+        engine->board.set(rook_from, setMoved(engine->board.get(rook_to), False));
+        engine->board.set(rook_to, Empty);
+        engine->game.pieces[undo.castly_rook].x = rook_from % 8;
+        engine->game.piece_map[rook_to] = -1;
+        engine->game.piece_map[rook_from] = undo.castly_rook;
+    }
+
+    // restore the hash, the evaluation totals and the last move made
+    engine->game.hash = undo.hash;
+    engine->game.eval = undo.eval;
+    engine->game.last_move = undo.last_move;
+
+    // restore the king's locations
+    engine->game.wking = undo.wking;
+    engine->game.bking = undo.bking;
+
+    // restore the last move flags
+    engine->game.last_was_en_passant = undo.last_was_en_passant;
+    engine->game.last_was_castle = undo.last_was_castle;
+    engine->game.last_was_pawn_promotion = undo.last_was_pawn_promotion;
+
+    engine->game.book_supplied = undo.book_supplied;
+    engine->game.user_supplied = undo.user_supplied;
+    engine->game.supply_valid = undo.supply_valid;
+
+    #ifdef ENA_HASH_CHECK
+    if (engine->game.hash != hash_board(engine->game.turn)) {
+        printf(Always, "hash mismatch: line %d\n", __LINE__);
+    }
+    #endif
+
+    #ifdef ENA_EVAL_CHECK
+    engine->game.calc_eval(engine->board, eval_check);
+    if (memcmp(&eval_check, &engine->game.eval, sizeof(eval_check))) {
+        printf(Always, "eval mismatch: line %d\n", __LINE__);
+    }
+    #endif
+
+}   // unmake(piece_gen_t const &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Move a piece on the board, taking a piece if necessary. Evaluate the value of the 
+// board after the move. Optionally restore the board back to it's original state after
+// evaluating the value of the move.
+// 
+// This is a big and complicated function.
+// It performs 5 major steps:
+// 
+//  1) Identify the piece being moved
+//  2) Identify any piece being captured and remove it if so
+//  3) Place the piece being moved at the destination
+//  4) Evaluate the board score after making the move
+//  5) If we are just considering the move then put everything back
+// 
+// Steps 1 to 3 are done by make(...) and step 5 by unmake(...).
+//
+// returns the value of the board after the move was made
+// 
+// Note: Sanitized stack
+long make_move(piece_gen_t & gen)
+{
+    // Stack Management
+    // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
+    // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
+    struct local_t {
+        uint8_t
+                          quiescent : 1,
+                             tt_hit : 1,
+                           tt_store : 1,
+                        null_window : 1,
+                          follow_pv : 1,
+                            qsearch : 1,
+                           in_check : 1;
+    } vars;
+
+    move_t  wbest, bbest;
+    int32_t recurse_value;
+    tt_entry_t const *entry;
+    uint64_t key;
+
+    //  Check for low stack space
+    if (check_mem(MAKE)) { return gen.whites_turn ? MIN_VALUE : MAX_VALUE; }
+
+    // Now we can alter local variables! 😎 
+
+    // The value of the board.
+    // Default to the worst value for our side.
+    // i.e: Don't make the move whatever it is
+    gen.move.value = (gen.whites_turn || engine->game.options.negamax) ? MIN_VALUE : MAX_VALUE;
+
+    // We haven't used or searched anything for the transposition table yet
+    vars.tt_hit = False;
+    vars.tt_store = False;
+    entry = nullptr;
+    key = 0;
+    recurse_value = 0;
+
+    if (gen.evaluating) {
+        engine->game.stats.inc_moves_count();
     }
 
 
+    /// Steps 1 to 3: Make the move
+    // 
+    // * NOTE BELOW *
+    // Once any changes have been made to the board or game state we MUST NOT return
+    // without passing through the "if (gen.evaluating) { ... }" restoration logic.
+
+    make(gen);
+
+
+    // See if the move leaves our King in check. We don't search any deeper
+    // after these moves since they aren't legal. Moves from the legal move
+    // generator don't need to be checked again.
+    vars.in_check = ((nullptr == gen.legal) || (gen.legal->side != gen.side)) &&
+        is_square_attacked(gen.whites_turn ? engine->game.wking : engine->game.bking, !gen.side);
+
+
     /// Step 4: Evaluate the board score after making the move
 
-    // Get the value of the current board
+    // Get the value of the current board. With negamax the value is
+    // from the point of view of the side making the move.
     gen.move.value = evaluate(gen);
+    if (engine->game.options.negamax && !gen.whites_turn) {
+        gen.move.value = -gen.move.value;
+    }
 
     // Control the percentage of moves that the engine makes a mistake on
-    if (0 != game.options.mistakes) {
-        if (random(100) <= (unsigned) game.options.mistakes) {
-            gen.move.value -= gen.whites_turn ? +5000 : -5000;
+    if (0 != search_config_t::mistakes()) {
+        if (engine->random(100) <= (unsigned) search_config_t::mistakes()) {
+            gen.move.value -= (gen.whites_turn || engine->game.options.negamax) ? +5000 : -5000;
         }
     }
 
-    // set our move as the last move
-    game.last_move = gen.move;
+    // our move is the last move
+    engine->game.last_move.value = gen.move.value;
 
     ////////////////////////////////////////////////////////////////////////////////////////
     // The move has been made and we have the value for the updated board.
     // Recursively look-ahead and accumulatively update the value here.
     // 
     if (gen.evaluating) {
-        // flag indicating whether we are traversing into quiescent moves
-        vars.quiescent = ((-1 != captured) && (game.ply < (game.options.max_quiescent_ply)) && (game.ply < game.options.max_max_ply));
+        // flag indicating whether we are traversing into quiescent moves. The quiescent
+        // search used with negamax follows the captures and promotions until there are
+        // none left, only stopping at max_max_ply. Otherwise the captures are followed
+        // up to max_quiescent_ply.
+        if (engine->game.options.negamax && engine->game.options.qsearch) {
+            vars.quiescent = ((-1 != engine->game.undo[engine->game.ply].captured) || engine->game.last_was_pawn_promotion) &&
+                (engine->game.ply < min((long) engine->game.options.max_max_ply, (long) MAX_PLY));
+        }
+        else {
+            vars.quiescent = ((-1 != engine->game.undo[engine->game.ply].captured) && (engine->game.ply < (engine->game.options.max_quiescent_ply)) && (engine->game.ply < engine->game.options.max_max_ply));
+        }
 
-        if (((game.ply < game.options.maxply) || vars.quiescent)) {
+        if (((engine->game.ply < engine->game.options.maxply) || vars.quiescent) && !vars.in_check) {
             if (!timeout()) {
                 // Indicate whether we are on a quiescent search or not
                 if (vars.quiescent) {
@@ -456,51 +729,132 @@ long make_move(piece_gen_t & gen)
                     direct_write(DEBUG2_PIN, LOW);
                 }
 
-                if ((0 == game.options.randskip) || (random(100) > (unsigned) game.options.randskip)) {
+                // See if we have already searched this position deeply enough to
+                // use the value we found then instead of searching it again. While
+                // randskip is skipping some of the replies the values found aren't
+                // the values of a full search, so the table isn't used at all then.
+                if (engine->game.options.trans_table && engine->game.options.negamax && (0 == search_config_t::randskip())) {
+                    key = engine->game.hash ^ zobrist(ZOB_SIDE);
+                    entry = engine->tt().probe(key);
+                    if ((engine->game.ply > 0) && (nullptr != entry) && (entry->depth >= engine->game.options.maxply - engine->game.ply)) {
+                        // The entries are from White's point of view
+                        recurse_value = value_from_entry(entry->value, engine->game.ply);
+                        recurse_value = gen.whites_turn ? recurse_value : -recurse_value;
+                        vars.tt_hit =
+                            (EXACT_BOUND == entry->bound) ||
+                            ((gen.whites_turn ? LOWER_BOUND : UPPER_BOUND) == entry->bound && recurse_value >= gen.beta) ||
+                            ((gen.whites_turn ? UPPER_BOUND : LOWER_BOUND) == entry->bound && recurse_value <= gen.alpha);
+                    }
+                }
+
+                if (vars.tt_hit) {
+                    // consider_negamax(...) narrows the window for us
+                    gen.move.value = recurse_value;
+                }
+                else if (engine->game.options.negamax && ((0 == engine->game.ply) || (0 == search_config_t::randskip()) || (engine->random(100) > (unsigned) search_config_t::randskip()))) {
+                    // Explore The Future! (plies) for the other side only, with the window
+                    // seen from its point of view. We never skip this at ply 0 since
+                    // that is how we find out if our move leaves the King in check.
+
+                    // Past maxply we only look at the captures and promotions
+                    // that follow a capture, in the quiescent search
+                    vars.qsearch = engine->game.options.qsearch && (engine->game.ply >= engine->game.options.maxply);
+
+                    // With principal variation search, the moves after the first move are
+                    // searched with a null window that can only prove they are no better
+                    vars.null_window = engine->game.options.pvs && !vars.qsearch && (gen.beta - gen.alpha > 1) &&
+                        (-1 != (gen.whites_turn ? gen.wbest : gen.bbest).from);
+
+                    // See if we are still following the last principal variation
+                    vars.follow_pv = gen.follow_pv && engine->pv.is_last(engine->game.ply, gen.move);
+
+                    engine->game.ply++;
+                    engine->game.turn = !engine->game.turn;
+                    engine->game.hash ^= zobrist(ZOB_SIDE);
+                    if (engine->game.ply > engine->game.stats.move_stats.depth) {
+                        engine->game.stats.move_stats.depth = engine->game.ply;
+                    }
+                    wbest = { -1, -1, MIN_VALUE };
+                    bbest = { -1, -1, MIN_VALUE };
+                    engine->pv.follow = vars.follow_pv;
+
+                    // The other side can stand pat on the value of the board after our move
+                    if (vars.qsearch) {
+                        quiesce(wbest, bbest, -gen.move.value, -gen.beta, -gen.alpha);
+                    }
+                    else {
+                        choose_best_moves(wbest, bbest, consider_negamax, vars.null_window ? (-gen.alpha - 1) : -gen.beta, -gen.alpha);
+                    }
+
+                    // If the null window search says this move is better after all
+                    // then search it again with the full window to get its value
+                    if (vars.null_window && (MIN_VALUE != (gen.whites_turn ? bbest : wbest).value) &&
+                        (-(gen.whites_turn ? bbest : wbest).value > gen.alpha) &&
+                        (-(gen.whites_turn ? bbest : wbest).value < gen.beta)) {
+                        wbest = { -1, -1, MIN_VALUE };
+                        bbest = { -1, -1, MIN_VALUE };
+                        engine->pv.follow = vars.follow_pv;
+                        choose_best_moves(wbest, bbest, consider_negamax, -gen.beta, -gen.alpha);
+                    }
+                    engine->game.turn = !engine->game.turn;
+                    engine->game.hash ^= zobrist(ZOB_SIDE);
+                    engine->game.ply--;
+
+                    // The other side's best reply is the value of our move
+                    if (MIN_VALUE != (gen.whites_turn ? bbest : wbest).value) {
+                        gen.move.value = -(gen.whites_turn ? bbest : wbest).value;
+                    }
+
+                    // Remember the results unless the search was cut short
+                    vars.tt_store = engine->game.options.trans_table && (0 == search_config_t::randskip()) && !engine->game.timeout2 && !engine->game.supply_valid && (PLAYING == engine->game.state);
+                }
+                else if (!engine->game.options.negamax && ((0 == search_config_t::randskip()) || (engine->random(100) > (unsigned) search_config_t::randskip()))) {
                     // Explore The Future! (plies)
-                    game.ply++;
-                    game.turn = !game.turn;
-                    if (game.ply > game.stats.move_stats.depth) {
-                        game.stats.move_stats.depth = game.ply;
+                    engine->game.ply++;
+                    engine->game.turn = !engine->game.turn;
+                    engine->game.hash ^= zobrist(ZOB_SIDE);
+                    if (engine->game.ply > engine->game.stats.move_stats.depth) {
+                        engine->game.stats.move_stats.depth = engine->game.ply;
                     }
-                    wbest = { -1, -1, game.alpha };
-                    bbest = { -1, -1, game.beta  };
+                    wbest = { -1, -1, engine->game.alpha };
+                    bbest = { -1, -1, engine->game.beta  };
                     reset_turn_flags();
                     choose_best_moves(wbest, bbest, consider_move);
-                    game.turn = !game.turn;
-                    game.ply--;
+                    engine->game.turn = !engine->game.turn;
+                    engine->game.hash ^= zobrist(ZOB_SIDE);
+                    engine->game.ply--;
 
                     if (gen.whites_turn) {
                         if (-1 != gen.wbest.from && -1 != gen.wbest.to) {
-                            if (game.options.alpha_beta_pruning) {
+                            if (search_config_t::alpha_beta_pruning()) {
                                 recurse_value = max(gen.move.value, gen.wbest.value);
-                                gen.move.value = game.options.integrate ? (gen.move.value + recurse_value) : recurse_value;
-                                if (gen.move.value > game.beta) {
+                                gen.move.value = search_config_t::integrate() ? (gen.move.value + recurse_value) : recurse_value;
+                                if (gen.move.value > engine->game.beta) {
                                     gen.cutoff = True;
                                 }
                                 else {
-                                    game.alpha = max((long) game.alpha, (long) gen.move.value);
+                                    engine->game.alpha = max((long) engine->game.alpha, (long) gen.move.value);
                                 }
                             }
                             else {
-                                gen.move.value = game.options.integrate ? (gen.move.value + gen.wbest.value) : gen.wbest.value;
+                                gen.move.value = search_config_t::integrate() ? (gen.move.value + gen.wbest.value) : gen.wbest.value;
                             }
                         }
                     }
                     else {
                         if (-1 != gen.bbest.from && -1 != gen.bbest.to) {
-                            if (game.options.alpha_beta_pruning) {
+                            if (search_config_t::alpha_beta_pruning()) {
                                 recurse_value = min(gen.move.value, gen.bbest.value);
-                                gen.move.value = game.options.integrate ? (gen.move.value + recurse_value) : recurse_value;
-                                if (gen.move.value < game.alpha) {
+                                gen.move.value = search_config_t::integrate() ? (gen.move.value + recurse_value) : recurse_value;
+                                if (gen.move.value < engine->game.alpha) {
                                     gen.cutoff = True;
                                 }
                                 else {
-                                    game.beta = min((long) game.beta, (long) gen.move.value);
+                                    engine->game.beta = min((long) engine->game.beta, (long) gen.move.value);
                                 }
                             }
                             else {
-                                gen.move.value = game.options.integrate ? (gen.move.value + gen.bbest.value) : gen.bbest.value;
+                                gen.move.value = search_config_t::integrate() ? (gen.move.value + gen.bbest.value) : gen.bbest.value;
                             }
                         }
                     }
@@ -509,19 +863,25 @@ long make_move(piece_gen_t & gen)
                     // beta boundaries. Now make sure this move didn't place our king in check
 
                     // if (gen.whites_turn) {
-                    //     if (game.white_king_in_check) {
+                    //     if (engine->game.white_king_in_check) {
                     //         gen.move.value = MIN_VALUE;
                     //     }
                     // }
                     // else {
-                    //     if (game.black_king_in_check) {
+                    //     if (engine->game.black_king_in_check) {
                     //         gen.move.value = MAX_VALUE;
                     //     }
                     // }
 
-                    if (game.ply > 0) {
-                        game.white_king_in_check = vars.white_king_in_check;
-                        game.black_king_in_check = vars.black_king_in_check;
+                    if (engine->game.ply > 0) {
+                        engine->game.white_king_in_check = engine->game.undo[engine->game.ply].white_king_in_check;
+                        engine->game.black_king_in_check = engine->game.undo[engine->game.ply].black_king_in_check;
+                    }
+
+                    // Remember the best reply unless the search was cut short
+                    vars.tt_store = engine->game.options.trans_table && (0 == search_config_t::randskip()) && !engine->game.timeout2 && !engine->game.supply_valid && (PLAYING == engine->game.state);
+                    if (vars.tt_store) {
+                        key = engine->game.hash ^ zobrist(ZOB_SIDE);
                     }
                 }
             }
@@ -533,80 +893,40 @@ long make_move(piece_gen_t & gen)
     /// Step 5: If we are just considering the move then put everything back
 
     if (gen.evaluating) {
-        if (-1 == captured) {
-            board.set(gen.move.to, vars.op);
-        } else {
-            // restore the captured board changes
-            board.set(captured, vars.captured_piece);
-
-            // restore the captured piece list changes
-            game.pieces[taken_index] = { index_t(captured % 8), index_t(captured / 8) };
-        }
-
-        // restore the taken pieces list changes
-        game.white_taken_count = vars.white_taken_count;
-        game.black_taken_count = vars.black_taken_count;
-
-        // restore the changes made to the moves history
-        memmove(game.history, history, sizeof(history));
-        game.hist_count = hist_count;
-
-        // restore the moved piece board changes
-        board.set(gen.move.from, gen.piece);
-
-        // restore the moved piece pieces list changes
-        game.pieces[gen.piece_index] = { index_t(gen.col), index_t(gen.row) };
-
-        // restore the last move made
-        game.last_move = last_move;
-
-        // restore the last move flags
-        game.last_was_en_passant = vars.last_was_en_passant;
-        game.last_was_castle = vars.last_was_castle;
-        game.last_was_pawn_promotion = vars.last_was_pawn_promotion;
-
-        // game.white_king_in_check = vars.white_king_in_check;
-        // game.black_king_in_check = vars.black_king_in_check;
-
-        game.book_supplied = vars.book_supplied;
-        game.user_supplied = vars.user_supplied;
-        game.supply_valid = vars.supply_valid;
+        unmake(gen);
 
         // Don't take the move if it leaves us in check
-        if (gen.whites_turn) {
-            if (game.white_king_in_check) {
-                gen.move.value = MIN_VALUE;
-            }
-        }
-        else {
-            if (game.black_king_in_check) {
-                gen.move.value = MAX_VALUE;
-            }
+        if (vars.in_check) {
+            gen.move.value = (gen.whites_turn || engine->game.options.negamax) ? MIN_VALUE : MAX_VALUE;
         }
 
-        // restore the king's locations
-        game.wking = vars.wking;
-        game.bking = vars.bking;
-
-        // restore any rook moved during a castle move
-        game.last_was_castle = vars.last_was_castle;
-        if (-1 != castly_rook) {
-            // Clear the rook from its castled position on the board
-            index_t rook_castled_col = game.pieces[castly_rook].x;
-            index_t rook_row = game.pieces[castly_rook].y;
-            Piece rook_piece = board.get(rook_castled_col + rook_row * 8);
-            board.set(rook_castled_col + rook_row * 8, Empty);
-
-            // Restore the rook to its original position
-            if (3 == rook_castled_col) {
-                game.pieces[castly_rook].x = 0;
+        // consider_move(...) looks at our check state again after adding its bonuses
+        if (!engine->game.options.negamax) {
+            if (gen.whites_turn) {
+                engine->game.white_king_in_check = vars.in_check;
             }
             else {
-                game.pieces[castly_rook].x = 7;
+                engine->game.black_king_in_check = vars.in_check;
             }
+        }
 
-            board.set(game.pieces[castly_rook].x + rook_row * 8,
-                setMoved(rook_piece, False));
+        // Remember the value of the position after this move along with the best reply.
+        // The values are stored from White's point of view with any mate counted
+        // from this position instead of from the root.
+        if (vars.tt_store && engine->game.options.negamax) {
+            engine->tt().store(key, engine->game.options.maxply - engine->game.ply,
+                (gen.move.value >= gen.beta)  ? (gen.whites_turn ? LOWER_BOUND : UPPER_BOUND) :
+                (gen.move.value <= gen.alpha) ? (gen.whites_turn ? UPPER_BOUND : LOWER_BOUND) : EXACT_BOUND,
+                value_to_entry(gen.whites_turn ? gen.move.value : -gen.move.value, engine->game.ply),
+                engine->game.turn ? bbest : wbest);
+        }
+        else if (vars.tt_store) {
+            // Remember the best reply so that it is searched first the next time.
+            // This search shares one alpha and beta between all of the plies, so the
+            // value it found could be a bound of either kind and can't be used in place
+            // of searching the position again. It is stored as at least MIN_VALUE,
+            // which is always true.
+            engine->tt().store(key, engine->game.options.maxply - engine->game.ply, LOWER_BOUND, MIN_VALUE, engine->game.turn ? bbest : wbest);
         }
 
     } // if (gen.evaluating)
@@ -620,7 +940,8 @@ long make_move(piece_gen_t & gen)
 // Evaluate the identity (score) of the board state.
 // Positive scores indicate an advantage for white and
 // Negative scores indicate an advantage for black.
-// Uses pre-computed material bonus tables for speed.
+// The material, center and King proximity totals are kept up to date in game.eval
+// by make_move(...) so only the mobility bonus is added here.
 // 
 // returns the score/value of the current board
 // 
@@ -630,86 +951,28 @@ long evaluate(piece_gen_t &gen)
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
-    long materialTotal, mobilityTotal, centerTotal, kingTotal, score;
-    index_t col, row, piece_index, kloc, col_dist, row_dist, proximity;
-    Piece p, ptype;
-    Color pside;
+    long mobilityTotal, score;
 
     //  Check for low stack space
     if (check_mem(MAKE)) { return 0; }
 
     // Now we can alter local variables! 😎 
 
-    // Calculate the value of the board:
-    materialTotal = 0L;
-    mobilityTotal = 0L;
-    centerTotal = 0L;
-    kingTotal = 0L;
-    score = 0L;
-
-    for (piece_index = 0; piece_index < game.piece_count; piece_index++) {
-        col = game.pieces[piece_index].x;
-        row = game.pieces[piece_index].y;
-        if (-1 == col || -1 == row) continue;
-
-        p = board.get(col + row * 8);
-        ptype = getType(p);
-        pside = getSide(p);
-
-        if (Empty == ptype) continue;
-
-        // Material Bonus
-        materialTotal += pgm_read_dword(&game.material_bonus[ptype][pside]) * game.options.materialBonus;
-
-        // In-Check Penalty
-        if (inCheck(p)) {
-            if (White == pside) {
-                materialTotal -= ptype;
-            }
-            else {
-                materialTotal += ptype;
-            }
-        }
-
-        // Let's not encourage the King to wander to
-        // the center of the board mmkay?
-        if (King == ptype) {
-            continue;
-        }
-
-        // Center Bonus
-        centerTotal +=
-            pgm_read_dword(&game.center_bonus[col][ptype][pside]) +
-            pgm_read_dword(&game.center_bonus[row][ptype][pside]);
-
-        // Proximity to opponent's King Bonus
-        kloc = (White == pside) ? game.bking : game.wking;
-        col_dist = (col > (kloc % 8)) ? (col - (kloc % 8)) : ((kloc % 8) - col);
-        row_dist = (row > (kloc / 8)) ? (row - (kloc / 8)) : ((kloc / 8) - row);
-        proximity = 14 - (col_dist + row_dist);
-        if (White == pside) {
-            kingTotal += proximity;
-        }
-        else {
-            kingTotal -= proximity;
-        }
-    }
-
-    kingTotal *= game.options.kingBonus;
-
     // Mobility Bonus
     if (gen.whites_turn) {
-        mobilityTotal += static_cast<long>(gen.num_wmoves * game.options.mobilityBonus);
+        mobilityTotal = static_cast<long>(gen.num_wmoves * engine->game.options.mobilityBonus);
     }
     else {
-        mobilityTotal -= static_cast<long>(gen.num_bmoves * game.options.mobilityBonus);
+        mobilityTotal = -static_cast<long>(gen.num_bmoves * engine->game.options.mobilityBonus);
     }
 
-    score = kingTotal + materialTotal + centerTotal + mobilityTotal;
+    score = engine->game.eval.material * engine->game.options.materialBonus +
+            engine->game.eval.center * engine->game.options.centerBonus +
+            engine->game.eval.proximity * engine->game.options.kingBonus + mobilityTotal;
 
     // printf(Debug4, 
     //     "evaluation: %ld = centerTotal: %ld  materialTotal: %ld  mobilityTotal: %ld\n", 
-    //     score, centerTotal, materialTotal, mobilityTotal);
+    //     score, engine->game.eval.center, engine->game.eval.material, mobilityTotal);
 
     return score;
 
@@ -717,10 +980,402 @@ long evaluate(piece_gen_t &gen)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// Evaluate all of the available moves for both sides.
+// Get the score used to order a move. Captures are ordered by the most valuable
+// victim and then by the least valuable attacker. Promotions that don't take
+// anything come after all of the captures.
+//
+// returns the score, or 0 for a quiet move
+uint8_t order_score(piece_gen_t const &gen)
+{
+    Piece const victim = getType(engine->board.get(gen.move.to));
+
+    if (Empty != victim) {
+        return victim * 8 + (7 - gen.type);
+    }
+
+    if (Pawn == gen.type) {
+        // A pawn moving diagonally to an empty spot is an en-passant capture
+        if (gen.col != (gen.move.to % 8)) {
+            return Pawn * 8 + (7 - Pawn);
+        }
+
+        if ((gen.move.to / 8) == (gen.whites_turn ? 0 : 7)) {
+            return 1;
+        }
+    }
+
+    return 0;
+
+}   // order_score(piece_gen_t const &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the score used to order a move that isn't the move to search first. Captures and
+// promotions come first, then the killer moves, and then the quiet moves by how often
+// they have caused a cutoff.
+//
+// returns the score, or 0 for a quiet move that has never caused a cutoff
+uint16_t move_score(piece_gen_t const &gen)
+{
+    uint16_t score;
+    index_t i;
+
+    score = order_score(gen);
+    if (0 != score) {
+        return ORDER_CAPTURE + score;
+    }
+
+    if (engine->game.options.quiet_order) {
+        i = engine->heuristics.killer(engine->game.ply, gen.move);
+        score = (-1 != i) ? (ORDER_KILLER - i) : engine->heuristics.score(gen.side, gen.move);
+    }
+
+    return score;
+
+}   // move_score(piece_gen_t const &gen)
+
+
+#ifdef ENA_MOVE_LIST
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the MOVE_XXX flags for a move
+uint8_t move_flags(piece_gen_t const &gen)
+{
+    uint8_t flags = 0;
+
+    if (!isEmpty(engine->board.get(gen.move.to))) {
+        flags |= MOVE_CAPTURE;
+    }
+
+    if (Pawn == gen.type) {
+        // A pawn moving diagonally to an empty spot is an en-passant capture
+        if ((gen.col != (gen.move.to % 8)) && (0 == flags)) {
+            flags |= MOVE_CAPTURE | MOVE_EN_PASSANT;
+        }
+
+        if ((gen.move.to / 8) == (gen.whites_turn ? 0 : 7)) {
+            flags |= MOVE_PROMOTION;
+        }
+    }
+    else if ((King == gen.type) && (abs((gen.move.to % 8) - gen.col) == 2)) {
+        flags |= MOVE_CASTLE;
+    }
+
+    return flags;
+
+}   // move_flags(piece_gen_t const &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Add a move for a node to the move stack along with its score. The move to search
+// first gets the highest score.
+void list_move(piece_gen_t &gen)
+{
+    order_t const &order = *gen.order;
+    Bool const best = (gen.move.from == order.best_from) && (gen.move.to == order.best_to);
+
+    engine->move_stack.add(engine->game.ply, gen.move.from, gen.move.to, move_flags(gen), best ? uint16_t(ORDER_BEST) : move_score(gen));
+
+}   // list_move(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Pass the moves on to the search that didn't fit on the move stack
+void visit_unlisted(piece_gen_t &gen)
+{
+    if (engine->move_stack.contains(engine->game.ply, gen.move.from, gen.move.to)) {
+        return;
+    }
+
+    gen.order->callback(gen);
+
+}   // visit_unlisted(piece_gen_t &gen)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Collect the moves for a node that are searched before the rest of the quiet moves,
+// highest score first. The move to search first is only noted.
+void collect_moves(piece_gen_t &gen)
+{
+    order_t &order = *gen.order;
+    uint16_t score;
+
+    if ((gen.move.from == order.best_from) && (gen.move.to == order.best_to)) {
+        order.best_found = True;
+        return;
+    }
+
+    score = move_score(gen);
+    if (0 == score) {
+        return;
+    }
+
+    // When the list is full the move with the lowest score is left for the quiet moves
+    insert_ordered(order, gen.move, score);
+
+}   // collect_moves(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Collect the captures and promotions for a node in the quiescent search, highest
+// score first. While they are collected the node's best value is the stand-pat value,
+// and captures that can't bring it up to alpha even with a margin are skipped.
+void collect_captures(piece_gen_t &gen)
+{
+    long const stand_pat = (gen.whites_turn ? gen.wbest : gen.bbest).value;
+    uint8_t const score = order_score(gen);
+    Piece victim;
+    long gain;
+
+    if (0 == score) {
+        return;
+    }
+
+    // Delta pruning. Taking the King is never skipped, that is how we
+    // find out the last move left it in check.
+    victim = getType(engine->board.get(gen.move.to));
+    if (King != victim) {
+        gain = pieceValues[(Empty == victim && gen.col != (gen.move.to % 8)) ? Pawn : victim];
+        if ((Pawn == gen.type) && ((gen.move.to / 8) == (gen.whites_turn ? 0 : 7))) {
+            gain += pieceValues[Queen] - pieceValues[Pawn];
+        }
+
+        if (stand_pat + gain + engine->game.options.deltaMargin <= gen.alpha) {
+            return;
+        }
+    }
+
+    // When the list is full the capture with the lowest score isn't searched
+    insert_ordered(*gen.order, gen.move, ORDER_CAPTURE + score);
+
+}   // collect_captures(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Add a move to a node's ordered moves after the moves with the same or a higher
+// score. When the list is full the move with the lowest score is dropped.
+void insert_ordered(order_t &order, move_t const &move, uint16_t const score)
+{
+    index_t i;
+
+    if (order.count >= MAX_ORDERED) {
+        if (score <= order.moves[MAX_ORDERED - 1].score) {
+            return;
+        }
+        order.count--;
+    }
+
+    for (i = order.count; (i > 0) && (order.moves[i - 1].score < score); i--) {
+        order.moves[i] = order.moves[i - 1];
+    }
+
+    order.moves[i] = { uint16_t(move.from), uint16_t(move.to), score };
+    order.count++;
+
+}   // insert_ordered(order_t &order, move_t const &move, uint16_t const score)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Pass the moves on to the search that weren't already searched ahead of the quiet moves
+void visit_quiet(piece_gen_t &gen)
+{
+    order_t const &order = *gen.order;
+    index_t i;
+
+    if ((gen.move.from == order.best_from) && (gen.move.to == order.best_to)) {
+        return;
+    }
+
+    for (i = 0; i < order.count; i++) {
+        if ((gen.move.from == order.moves[i].from) && (gen.move.to == order.moves[i].to)) {
+            return;
+        }
+    }
+
+    order.callback(gen);
+
+}   // visit_quiet(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set up a piece_gen_t to generate the moves for one of the game.pieces[] entries
+//
+// returns False if the piece has been taken or isn't for the side being searched
+Bool set_gen_piece(piece_gen_t &gen, index_t const piece_index)
+{
+    // Skip the pieces that have been taken. This has to be checked before
+    // setting gen.col since the 3-bit field can't hold -1
+    if (-1 == engine->game.pieces[piece_index].x) { return False; }
+
+    // Construct a move_t object with the starting location
+    gen.piece_index = piece_index;
+    gen.col = engine->game.pieces[piece_index].x;
+    gen.row = engine->game.pieces[piece_index].y;
+    gen.move.from = gen.col + gen.row * 8u;
+    gen.move.to = -1;
+    gen.piece = engine->board.get(gen.move.from);
+    gen.type = getType(gen.piece);
+    gen.side = getSide(gen.piece);
+    gen.whites_turn = gen.side; // same as White == gen.side
+    gen.move.value = gen.whites_turn ? MIN_VALUE : MAX_VALUE;
+
+    if (Empty == gen.type) {
+        return False;
+    }
+
+    // negamax only looks at the moves for the side to move
+    if (engine->game.options.negamax && (gen.side != engine->game.turn)) {
+        return False;
+    }
+
+    return True;
+
+}   // set_gen_piece(piece_gen_t &gen, index_t const piece_index)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Remember the first move generated and ignore the rest
+void take_first(piece_gen_t &gen)
+{
+    if (!gen.cutoff) {
+        (gen.whites_turn ? gen.wbest : gen.bbest) = gen.move;
+        gen.cutoff = True;
+    }
+
+}   // take_first(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Find the first legal move for the side to move
+//
+// returns False if the side to move has no legal moves
+Bool first_legal_move(move_t &best)
+{
+    index_t index;
+    legal_t legal;
+    move_t move = { -1, -1, 0 };
+    move_t wbest = { -1, -1, best.value };
+    move_t bbest = { -1, -1, best.value };
+    piece_gen_t gen(move, wbest, bbest, take_first, True);
+
+    find_checks_and_pins(legal, engine->game.turn);
+    gen.legal = &legal;
+
+    for (index = 0; (index < engine->game.piece_count) && !gen.cutoff; index++) {
+        if (set_gen_piece(gen, index) && (gen.side == engine->game.turn)) {
+            add_piece_moves(gen);
+        }
+    }
+
+    if (!gen.cutoff) {
+        return False;
+    }
+
+    best = engine->game.turn ? wbest : bbest;
+    return True;
+
+}   // first_legal_move(move_t &best)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// The number of moves counted by perft(...) and the ply they are counted at
+static uint32_t perft_nodes;
+static index_t  perft_ply;
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Generate the moves for the side to move and pass each one to perft_move(...)
+static void perft_node()
+{
+    index_t index;
+    legal_t legal;
+    move_t move = { -1, -1, 0 };
+    move_t wbest = { -1, -1, MIN_VALUE };
+    move_t bbest = { -1, -1, MIN_VALUE };
+    piece_gen_t gen(move, wbest, bbest, perft_move, True);
+
+    if (engine->game.options.legal_moves) {
+        find_checks_and_pins(legal, engine->game.turn);
+        gen.legal = &legal;
+    }
+
+    for (index = 0; index < engine->game.piece_count; index++) {
+        if (set_gen_piece(gen, index) && (gen.side == engine->game.turn)) {
+            add_piece_moves(gen);
+        }
+    }
+
+}   // perft_node()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Make a move and count it, or count the moves after it if it isn't at the last ply.
+// The moves from the pseudo-legal move generator that leave our King in check are
+// taken back without being counted.
+void perft_move(piece_gen_t &gen)
+{
+    make(gen);
+
+    if ((nullptr != gen.legal) || !is_square_attacked(gen.whites_turn ? engine->game.wking : engine->game.bking, !gen.side)) {
+        if (engine->game.ply + 1 >= perft_ply) {
+            perft_nodes++;
+        }
+        else {
+            engine->game.ply++;
+            engine->game.turn = !engine->game.turn;
+            engine->game.hash ^= zobrist(ZOB_SIDE);
+            perft_node();
+            engine->game.turn = !engine->game.turn;
+            engine->game.hash ^= zobrist(ZOB_SIDE);
+            engine->game.ply--;
+        }
+    }
+
+    unmake(gen);
+
+}   // perft_move(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Count the positions reached by playing every sequence of legal moves of the given
+// depth from the current position. The counts are compared to the known counts to
+// test the move generators along with make(...) and unmake(...). The moves are
+// generated with game.options.legal_moves like they are during the search.
+//
+// returns the number of positions found, or 0 if the depth is more than game.undo[]
+// holds
+uint32_t perft(index_t const depth)
+{
+    if (depth <= 0) {
+        return 1;
+    }
+
+    if (engine->game.ply + depth > MAX_PLY + 1) {
+        return 0;
+    }
+
+    perft_nodes = 0;
+    perft_ply = engine->game.ply + depth;
+    perft_node();
+
+    return perft_nodes;
+
+}   // perft(index_t const depth)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Evaluate all of the available moves for both sides.
 // The best moves are stored in wbest and bbest.
 // The callback is called for each move, implementing the visitor pattern.
 // 
+// When searching with negamax only the moves for the side to move are evaluated,
+// within the alpha-beta window given, and only its best move is set.
+//
+// When ordering moves the first walk through the pieces only collects the moves.
+// Then the best move from the transposition table or the principal variation is
+// searched, then the captures and promotions by score, then the killer moves and
+// the quiet moves with a history, and then the rest of the quiet moves.
+//
 // This function is the top of the recursive call chain:
 // 
 //  choose_best_move(...)
@@ -730,7 +1385,7 @@ long evaluate(piece_gen_t &gen)
 //                  choose_best_move(...)
 // 
 // Note: Sanitized stack
-void choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback)
+void choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback, long const alpha, long const beta)
 {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
@@ -742,19 +1397,83 @@ void choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback)
     // Now we can alter local variables!
     else {
         static uint32_t last_led_update;
-        index_t move_count;
+        index_t move_count, index, first;
+        tt_entry_t const *entry;
+        order_t order;
+        legal_t legal;
+        Bool has_moves;
         move_t move = { -1, -1, 0 };
         piece_gen_t gen(move, wbest, bbest, callback, True);
 
         gen.num_wmoves = 0;
         gen.num_bmoves = 0;
+        gen.alpha = alpha;
+        gen.beta = beta;
+
+        if (engine->game.options.negamax) {
+            (engine->game.turn ? wbest : bbest) = { -1, -1, MIN_VALUE };
+            engine->pv.clear(engine->game.ply);
+            gen.follow_pv = engine->pv.follow;
+        }
 
         // Turn off the 'King in check' LED
         direct_write(DEBUG4_PIN, LOW);
 
+        order.callback = callback;
+        order.count = 0;
+        order.best_from = -1;
+        order.best_to = -1;
+        order.best_found = False;
+
+        // Find the checks and pins for the side to move once so that
+        // only its legal moves are generated
+        if (engine->game.options.legal_moves) {
+            find_checks_and_pins(legal, engine->game.turn);
+            gen.legal = &legal;
+        }
+        has_moves = False;
+
+        // If we've searched this position before then evaluate
+        // the best move we found back then first
+        if (engine->game.options.trans_table) {
+            entry = engine->tt().probe(engine->game.hash);
+            if ((nullptr != entry) && (entry->from != entry->to)) {
+                order.best_from = entry->from;
+                order.best_to = entry->to;
+            }
+        }
+
+        // If we are following the last principal variation then
+        // evaluate its move first instead
+        if (gen.follow_pv && (-1 != engine->pv.last_from(engine->game.ply))) {
+            order.best_from = engine->pv.last_from(engine->game.ply);
+            order.best_to = engine->pv.last_to(engine->game.ply);
+        }
+
+        // When ordering moves we only collect them on the first walk through the
+        // pieces. Otherwise we evaluate the moves for the piece with the best move first.
+        first = -1;
+        #ifdef ENA_MOVE_LIST
+        if (engine->game.options.move_list) {
+            engine->move_stack.begin(engine->game.ply);
+            gen.order = &order;
+            gen.callme = list_move;
+        }
+        else
+        #endif
+        if (engine->game.options.move_order) {
+            gen.order = &order;
+            gen.callme = collect_moves;
+        }
+        else if (-1 != order.best_from) {
+            first = engine->game.find_piece(order.best_from);
+        }
+
         // Walk through the game.pieces[] list and evaluate the moves for each one
-        for (gen.piece_index = 0; gen.piece_index < game.piece_count; gen.piece_index++) {
-            if (game.supply_valid || (PLAYING != game.state)) {
+        for (index = (-1 == first) ? 0 : -1; index < engine->game.piece_count; index++) {
+            if (index == first) { continue; }
+
+            if (engine->game.supply_valid || (PLAYING != engine->game.state)) {
                 return;
             }
 
@@ -762,27 +1481,14 @@ void choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback)
                 return;
             }
             else {
-                gen.col = game.pieces[gen.piece_index].x;
-                if (-1 == gen.col) { continue; }
-    
-                // Construct a move_t object with the starting location
-                gen.row = game.pieces[gen.piece_index].y;
-                gen.move.from = gen.col + gen.row * 8u;
-                gen.move.to = -1;
-                gen.piece = board.get(gen.move.from);
-                gen.type = getType(gen.piece);
-                gen.side = getSide(gen.piece);
-                gen.whites_turn = gen.side; // same as White == gen.side
-                gen.move.value = gen.whites_turn ? MIN_VALUE : MAX_VALUE;
-    
-                if (Empty == gen.type) {
+                if (!set_gen_piece(gen, (-1 == index) ? first : index)) {
                     continue;
                 }
-    
+
                 // Periodically update the LED strip display and progress indicator if enabled
-                if (game.options.live_update 
-                // && (game.ply < game.options.max_max_ply)
-                // && (game.ply <= game.options.maxply)
+                if (search_config_t::live_update() 
+                // && (engine->game.ply < engine->game.options.max_max_ply)
+                // && (engine->game.ply <= engine->game.options.maxply)
                 ) {
                     if ((millis() - last_led_update) >= 10)
                     {
@@ -791,93 +1497,317 @@ void choose_best_moves(move_t &wbest, move_t &bbest, generator_t const callback)
                     }
                 }
 
-                // Keep track of the location of the Kings
-                if (King == gen.type) {
-                    (gen.whites_turn ? game.wking : game.bking) = gen.move.from;
+                // Keep track of the location of the Kings
+                if (King == gen.type) {
+                    (gen.whites_turn ? engine->game.wking : engine->game.bking) = gen.move.from;
+                }
+
+                // Check for move timeout (only if we're at ply level 2 or above, 
+                // this happens internally in the timeout() function)
+                if (timeout()) {
+                    break;
+                }
+    
+                // Evaluate the moves for this Piece Type and get the highest value move
+                move_count = add_piece_moves(gen);
+
+                // Keep track of the total number of moves for this side
+                (gen.whites_turn ? gen.num_wmoves : gen.num_bmoves) += move_count;
+                if ((0 != move_count) && (gen.side == engine->game.turn)) {
+                    has_moves = True;
+                }
+    
+                // Check for alpha or beta cuttoff
+                if (gen.cutoff) {
+                    break;
+                }
+    
+                // Check for move timeout if we've finished ply level 1
+                if (engine->game.timeout1) {
+                    break;
+                }
+            }
+    
+        } // for each piece on both sides
+
+        #ifdef ENA_MOVE_LIST
+        if (engine->game.options.move_list) {
+            // Search the moves on the move stack highest score first
+            stack_move_t const *listed;
+            while (!gen.cutoff && !engine->game.timeout1 && (nullptr != (listed = engine->move_stack.next(engine->game.ply)))) {
+                if (engine->game.supply_valid || (PLAYING != engine->game.state)) {
+                    return;
+                }
+
+                set_gen_piece(gen, engine->game.find_piece(listed->move.from));
+                gen.move.to = listed->move.to;
+                callback(gen);
+            }
+
+            // Walk through the pieces again for the moves that didn't fit
+            if (engine->move_stack.spilled(engine->game.ply)) {
+                gen.callme = visit_unlisted;
+                for (index = 0; (index < engine->game.piece_count) && !gen.cutoff && !engine->game.timeout1; index++) {
+                    if (engine->game.supply_valid || (PLAYING != engine->game.state) || check_serial()) {
+                        return;
+                    }
+
+                    if (!set_gen_piece(gen, index)) {
+                        continue;
+                    }
+
+                    if (timeout()) {
+                        break;
+                    }
+
+                    add_piece_moves(gen);
+                }
+            }
+        }
+        else
+        #endif
+        if (engine->game.options.move_order) {
+            // Search the best move from before if it was generated,
+            // and then the moves we collected in the order of their scores
+            for (index = -1; (index < order.count) && !gen.cutoff && !engine->game.timeout1; index++) {
+                if ((-1 == index) && !order.best_found) { continue; }
+
+                if (engine->game.supply_valid || (PLAYING != engine->game.state)) {
+                    return;
+                }
+
+                set_gen_piece(gen, engine->game.find_piece((-1 == index) ? order.best_from : order.moves[index].from));
+                gen.move.to = (-1 == index) ? order.best_to : order.moves[index].to;
+                callback(gen);
+            }
+
+            // Walk through the pieces again to search the quiet moves
+            gen.callme = visit_quiet;
+            for (index = 0; (index < engine->game.piece_count) && !gen.cutoff && !engine->game.timeout1; index++) {
+                if (engine->game.supply_valid || (PLAYING != engine->game.state) || check_serial()) {
+                    return;
+                }
+
+                if (!set_gen_piece(gen, index)) {
+                    continue;
+                }
+
+                if (timeout()) {
+                    break;
+                }
+
+                add_piece_moves(gen);
+            }
+        }
+
+        // With negamax, if there are no legal moves (or every move lets the King be
+        // taken when we aren't generating only legal moves) then it is checkmate when
+        // the King is in check now, and stalemate when it isn't. This isn't done when
+        // the search was cut short and no moves were looked at.
+        if (engine->game.options.negamax) {
+            move_t &best = engine->game.turn ? wbest : bbest;
+
+            if (((nullptr != gen.legal) ? !has_moves : (MIN_VALUE == best.value)) &&
+                !engine->game.timeout1 && !engine->game.supply_valid && (PLAYING == engine->game.state)) {
+                if ((nullptr != gen.legal) ? (0 != legal.checkers) : king_in_check(engine->game.turn)) {
+                    best.value = MIN_VALUE + engine->game.ply;
+                    if (0 == engine->game.ply) {
+                        engine->game.state = engine->game.turn ? BLACK_CHECKMATE : WHITE_CHECKMATE;
+                    }
+                }
+                else {
+                    best.value = 0;
+                    if (0 == engine->game.ply) {
+                        engine->game.state = STALEMATE;
+                    }
+                }
+            }
+
+            if (0 == engine->game.ply) {
+                if (2 == engine->game.piece_count) {
+                    engine->game.state = STALEMATE;
+                }
+
+                // Give the caller the value from White's point of view like the other search
+                if (!engine->game.turn) {
+                    best.value = -best.value;
+                }
+            }
+
+            return;
+        }
+    
+        // See if the game is over
+        if (0 == engine->game.ply) {
+            // See if we only have the two kings on either side:
+            if (2 == engine->game.piece_count) {
+                engine->game.state = STALEMATE;
+            }
+
+            // With legal move generation we know exactly when the side to move has no moves
+            if (nullptr != gen.legal) {
+                if (!has_moves && !engine->game.timeout1 && (PLAYING == engine->game.state)) {
+                    if (0 != legal.checkers) {
+                        engine->game.state = engine->game.turn ? BLACK_CHECKMATE : WHITE_CHECKMATE;
+                    }
+                    else {
+                        engine->game.state = STALEMATE;
+                    }
+                }
+                return;
+            }
+
+            if ((0 == gen.num_wmoves) && (0 == gen.num_bmoves)) {
+                engine->game.state = STALEMATE;
+            }
+
+            if ((0 == gen.num_wmoves) && engine->game.white_king_in_check) {
+                engine->game.state = BLACK_CHECKMATE;
+            }
+
+            if ((0 == gen.num_bmoves) && engine->game.black_king_in_check) {
+                engine->game.state = WHITE_CHECKMATE;
+            }
+        }
+    }
+
+
+}   // choose_best_moves(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// The quiescent search for the side to move with negamax. Only the captures and
+// promotions are searched, in MVV-LVA order, and the side to move can always stand
+// pat on the value of the board instead. The best move is left with no move and the
+// stand-pat value when none of the captures are better.
+//
+// A side in check can't stand pat since the move it makes has to get out of check,
+// so all of its legal moves are searched instead, and with none it is checkmate.
+//
+// Note: Sanitized stack
+void quiesce(move_t &wbest, move_t &bbest, long const stand_pat, long const alpha, long const beta)
+{
+    // Stack Management
+    // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
+    // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
+
+    //  Check for low stack space
+    if (check_mem(CHOOSE)) { return; }
+
+    // Now we can alter local variables!
+    else {
+        index_t index;
+        order_t order;
+        legal_t legal;
+        Bool in_check;
+        move_t move = { -1, -1, 0 };
+        move_t &best = engine->game.turn ? wbest : bbest;
+        piece_gen_t gen(move, wbest, bbest, collect_captures, True);
+
+        engine->pv.clear(engine->game.ply);
+
+        // The checks and pins are needed to get out of check even when we
+        // aren't generating only the legal moves
+        if (engine->game.options.legal_moves || king_in_check(engine->game.turn)) {
+            find_checks_and_pins(legal, engine->game.turn);
+            gen.legal = &legal;
+        }
+        in_check = (nullptr != gen.legal) && (0 != legal.checkers);
+
+        if (in_check) {
+            best = { -1, -1, MIN_VALUE };
+            gen.alpha = alpha;
+            gen.beta = beta;
+            gen.callme = consider_negamax;
+
+            // Search every move that gets out of check
+            for (index = 0; (index < engine->game.piece_count) && !gen.cutoff; index++) {
+                if (engine->game.supply_valid || (PLAYING != engine->game.state) || check_serial()) {
+                    return;
+                }
+
+                if (!set_gen_piece(gen, index)) {
+                    continue;
                 }
 
-                // Check for move timeout (only if we're at ply level 2 or above, 
-                // this happens internally in the timeout() function)
                 if (timeout()) {
-                    break;
-                }
-    
-                move_count = 0;
-    
-                // Evaluate the moves for this Piece Type and get the highest value move
-                switch (gen.type) {
-                    default: printf(Always, "bad type: line %d\n", __LINE__);   break;
-                    case   Pawn:    move_count = add_pawn_moves(gen);           break;
-                    case Knight:    move_count = add_knight_moves(gen);         break;
-                    case Bishop:    move_count = add_bishop_moves(gen);         break;
-                    case   Rook:    move_count = add_rook_moves(gen);           break;
-                    case  Queen:    move_count = add_queen_moves(gen);          break;
-                    case   King:    
-                        move_count = add_king_moves(gen);
-                        // if (0 == move_count) {
-                        //     if (White == gen.side && game.white_king_in_check) {
-                        //         game.state = BLACK_CHECKMATE;
-                        //         return;
-                        //     }
-
-                        //     if (Black == gen.side && game.black_king_in_check) {
-                        //         game.state = WHITE_CHECKMATE;
-                        //         return;
-                        //     }
-                        // }
-                        break;
+                    return;
                 }
 
-                // Keep track of the total number of moves for this side
-                (gen.whites_turn ? gen.num_wmoves : gen.num_bmoves) += move_count;
-    
-                // Check for alpha or beta cuttoff
-                if (gen.cutoff) {
-                    break;
-                }
-    
-                // Check for move timeout if we've finished ply level 1
-                if (game.timeout1) {
-                    break;
-                }
+                add_piece_moves(gen);
             }
-    
-        } // for each piece on both sides
-    
-        // See if the game is over
-        if (0 == game.ply) {
-            // See if we only have the two kings on either side:
-            if (2 == game.piece_count) {
-                game.state = STALEMATE;
+
+            if (-1 == best.from) {
+                best.value = MIN_VALUE + engine->game.ply;
             }
 
-            if ((0 == gen.num_wmoves) && (0 == gen.num_bmoves)) {
-                game.state = STALEMATE;
+            return;
+        }
+
+        best = { -1, -1, stand_pat };
+
+        // Stand pat if the board is already good enough for a cutoff
+        if (search_config_t::alpha_beta_pruning() && (stand_pat >= beta)) {
+            return;
+        }
+
+        gen.alpha = max(alpha, stand_pat);
+        gen.beta = beta;
+        gen.order = &order;
+
+        order.callback = consider_negamax;
+        order.count = 0;
+        order.best_from = -1;
+        order.best_to = -1;
+        order.best_found = False;
+
+        // Collect the captures and promotions for the side to move
+        for (index = 0; index < engine->game.piece_count; index++) {
+            if (engine->game.supply_valid || (PLAYING != engine->game.state) || check_serial()) {
+                return;
             }
 
-            if ((0 == gen.num_wmoves) && game.white_king_in_check) {
-                game.state = BLACK_CHECKMATE;
+            if (!set_gen_piece(gen, index)) {
+                continue;
             }
 
-            if ((0 == gen.num_bmoves) && game.black_king_in_check) {
-                game.state = WHITE_CHECKMATE;
+            if (timeout()) {
+                return;
             }
+
+            add_piece_moves(gen);
         }
-    }
 
+        // Search them in the order of their scores
+        for (index = 0; (index < order.count) && !gen.cutoff && !engine->game.timeout1; index++) {
+            if (engine->game.supply_valid || (PLAYING != engine->game.state)) {
+                return;
+            }
 
-}   // choose_best_moves(...)
+            set_gen_piece(gen, engine->game.find_piece(order.moves[index].from));
+            gen.move.to = order.moves[index].to;
+            consider_negamax(gen);
+        }
+
+        // consider_negamax(...) takes the first move it sees even when standing pat is better
+        if (best.value < stand_pat) {
+            best = { -1, -1, stand_pat };
+            engine->pv.clear(engine->game.ply);
+        }
+    }
+
+}   // quiesce(...)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// Set the per-side options. This allows testing feature choices against each other
+// Set the per-side options. This allows testing feature choices against each other.
+// The side to move searches the whole turn with its own options.
 void set_per_side_options() {
-    if (game.turn) {
-        // White's turn
-    }
-    else {
-        // Black's turn
+    #ifdef ENA_MATCH
+    if (engine->game.options.per_side) {
+        engine->game.options.set_side(engine->game.options.sides[engine->game.turn]);
     }
+    #endif
 }
 
 
@@ -897,31 +1827,138 @@ void reset_turn_flags()
 
     // Now we can alter local variables! 😎 
 
-    for (index = 0; index < game.piece_count; index++) {
-        if (-1 == game.pieces[index].x) { continue; }
-        board.set(         game.pieces[index].x + game.pieces[index].y * 8, 
-        setCheck(board.get(game.pieces[index].x + game.pieces[index].y * 8), False));
+    for (index = 0; index < engine->game.piece_count; index++) {
+        if (-1 == engine->game.pieces[index].x) { continue; }
+        engine->board.set(         engine->game.pieces[index].x + engine->game.pieces[index].y * 8, 
+        setCheck(engine->board.get(engine->game.pieces[index].x + engine->game.pieces[index].y * 8), False));
     }
 
     // reset the king-in-check flags
-    game.white_king_in_check = False;
-    game.black_king_in_check = False;
-
-    game.last_was_en_passant = False;
-    game.last_was_castle = False;
-    game.timeout1 = False;
-    game.timeout2 = False;
-    game.last_was_pawn_promotion = False;
+    engine->game.white_king_in_check = False;
+    engine->game.black_king_in_check = False;
 
-    game.book_supplied = False;
-    game.user_supplied = False;
-    game.supply_valid = False;
+    engine->game.last_was_en_passant = False;
+    engine->game.last_was_castle = False;
+    engine->game.timeout1 = False;
+    engine->game.timeout2 = False;
+    engine->game.last_was_pawn_promotion = False;
 
-    set_per_side_options();
+    engine->game.book_supplied = False;
+    engine->game.user_supplied = False;
+    engine->game.supply_valid = False;
 
 }   // reset_turn_flags()
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Choose the best moves from the root of the search. With the root split and
+// split == True the root moves are shared out between the threads.
+void search_root(move_t &wbest, move_t &bbest, Bool const split)
+{
+    #ifdef ENA_SMP
+    if (split && smp.split(wbest, bbest)) {
+        return;
+    }
+    #else
+    (void) split;
+    #endif
+
+    choose_best_moves(wbest, bbest, engine->game.options.negamax ? consider_negamax : consider_move);
+
+}   // search_root(move_t &wbest, move_t &bbest, Bool const split)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Choose the best moves by searching 1 ply deep, then 2, and so on up to the
+// configured maxply. The moves from the last search that finished are kept so a
+// timeout never leaves us with a move from a partially searched ply. We don't
+// start another search if it is projected to take longer than the time left.
+void iterative_deepening(move_t &wmove, move_t &bmove)
+{
+    index_t  const maxply = engine->game.options.maxply;
+    index_t  const max_quiescent_ply = engine->game.options.max_quiescent_ply;
+    uint32_t last_took = UINT32_MAX;
+    uint32_t elapsed = 0;
+    uint32_t took = 0;
+    uint32_t projected = 0;
+
+    for (index_t depth = 1; depth <= maxply; depth++) {
+        move_t iwmove = { -1, -1, MIN_VALUE };
+        move_t ibmove = { -1, -1, MAX_VALUE };
+        uint32_t const start = engine->game.stats.move_stats.duration();
+
+        // Search to this depth with the full alpha-beta window
+        engine->game.options.maxply = depth;
+        engine->game.options.max_quiescent_ply = min((long) depth + 1, (long) engine->game.options.max_max_ply);
+        engine->game.alpha = MIN_VALUE;
+        engine->game.beta  = MAX_VALUE;
+        engine->game.timeout1 = False;
+        engine->game.timeout2 = False;
+
+        // Search the last depth's principal variation first
+        engine->pv.follow = True;
+
+        // The root split only searches the last depth. The shallower ones are quick, and
+        // searching them on one thread leaves the killer moves and history counts that
+        // order the last depth the same as they are without it, so the same move is chosen.
+        search_root(iwmove, ibmove, depth == maxply);
+
+        // A supplied move is validated by the first search, and the game
+        // might be over. Either way there is nothing more to search.
+        if (engine->game.supply_valid || (PLAYING != engine->game.state)) {
+            break;
+        }
+
+        // Keep these moves unless the search was cut short. We keep the first
+        // search regardless since it is better than no move at all.
+        if (!engine->game.timeout2 || (1 == depth)) {
+            wmove = iwmove;
+            bmove = ibmove;
+            engine->pv.save();
+            printf(Debug2, "Depth %d complete\n", depth);
+        }
+
+        if (engine->game.timeout2) {
+            break;
+        }
+
+        if (0 == engine->game.options.time_limit) {
+            continue;
+        }
+
+        // Project the time for the next depth from how much this one grew over the
+        // last one, assuming it grows by at least 2x, and stop if it won't finish
+        elapsed = engine->game.stats.move_stats.duration();
+        took = max(1UL, (unsigned long) (elapsed - start));
+        projected = took * max(2UL, (unsigned long) (took / last_took));
+        last_took = took;
+
+        if (elapsed + projected > engine->game.options.time_limit) {
+            break;
+        }
+    }
+
+    engine->game.options.maxply = maxply;
+    engine->game.options.max_quiescent_ply = max_quiescent_ply;
+
+}   // iterative_deepening(move_t &wmove, move_t &bmove)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Choose the best moves for both sides, with iterative deepening if it is enabled
+void search_moves(move_t &wmove, move_t &bmove)
+{
+    if (engine->game.options.iterative) {
+        iterative_deepening(wmove, bmove);
+    }
+    else {
+        search_root(wmove, bmove, True);
+        engine->pv.save();
+    }
+
+}   // search_moves(move_t &wmove, move_t &bmove)
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Make the next move in the game
 void take_turn()
@@ -933,8 +1970,8 @@ void take_turn()
     direct_write(DEBUG4_PIN, LOW);
 
     // See if we've hit the move limit and return if so
-    if (game.move_num >= game.options.move_limit) {
-        game.state = MOVE_LIMIT;
+    if (engine->game.move_num >= engine->game.options.move_limit) {
+        engine->game.state = MOVE_LIMIT;
         return;
     }
 
@@ -943,21 +1980,28 @@ void take_turn()
     move_t bmove = { -1, -1, MAX_VALUE };
 
     // Gather the move statistics for this turn
-    game.stats.start_move_stats();
-    game.stats.move_stats.depth = 0;
+    engine->game.stats.start_move_stats();
+    engine->game.stats.move_stats.depth = 0;
 
     reset_turn_flags();
+    set_per_side_options();
+
+    // Forget the principal variation from the last turn
+    engine->pv.init();
+
+    // Let the killer moves and history counts from the last turn count for less
+    engine->heuristics.age();
 
     // Set the alpha and beta edges to the worst case (brute force)
     // O(N) based on whose turn it is. Math is so freakin cool..
-    game.alpha = wmove.value;
-    game.beta  = bmove.value;
+    engine->game.alpha = wmove.value;
+    engine->game.beta  = bmove.value;
 
-    Bool const whites_turn = game.turn; // same as (White == game.turn) ? True : False;
+    Bool const whites_turn = engine->game.turn; // same as (White == engine->game.turn) ? True : False;
     move_t move = { -1, -1, whites_turn ? MIN_VALUE : MAX_VALUE };
 
     // Handle human player input if applicable
-    Bool is_human_turn = (whites_turn && game.options.white_human) || (!whites_turn && game.options.black_human);
+    Bool is_human_turn = (whites_turn && engine->game.options.white_human) || (!whites_turn && engine->game.options.black_human);
     if (is_human_turn) {
         Bool valid_input = False;
         while (!valid_input) {
@@ -974,22 +2018,22 @@ void take_turn()
             // See if we have an opening book move (for AI fallback if needed, but skip for human)
             check_book();  // Optional, but keep if book can override invalid human moves; remove if pure human
 
-            if (game.options.shuffle_pieces) {
-                game.sort_pieces(game.turn);
-                game.shuffle_pieces(SHUFFLE);
+            if (engine->game.options.shuffle_pieces) {
+                engine->game.sort_pieces(engine->game.turn);
+                engine->game.shuffle_pieces(SHUFFLE);
             }
 
             // Choose the best moves (this will validate supplied via consider_move)
-            choose_best_moves(wmove, bmove, consider_move);
+            choose_best_moves(wmove, bmove, engine->game.options.negamax ? consider_negamax : consider_move);
 
             // Check if the supplied move was valid (matched a legal generated move)
-            if (game.supply_valid) {
+            if (engine->game.supply_valid) {
                 valid_input = True;
             } else {
                 printf(Debug1, "Invalid move - try again.\n");
                 // Reset supplied flags for next attempt
-                game.user_supplied = False;
-                game.supplied = { -1, -1, 0L };
+                engine->game.user_supplied = False;
+                engine->game.supplied = { -1, -1, 0L };
             }
         }
     } else {
@@ -997,30 +2041,54 @@ void take_turn()
         // See if we have an opening book move
         check_book();
 
-        if (game.options.shuffle_pieces) {
-            game.sort_pieces(game.turn);
-            game.shuffle_pieces(SHUFFLE);
+        if (engine->game.options.shuffle_pieces) {
+            engine->game.sort_pieces(engine->game.turn);
+            engine->game.shuffle_pieces(SHUFFLE);
         }
 
         // Choose the best moves for both sides
-        choose_best_moves(wmove, bmove, consider_move);
+        #ifdef ENA_SMP
+        smp.search(wmove, bmove);
+        #else
+        search_moves(wmove, bmove);
+        #endif
     }
 
     // Gather the move statistics for this turn
-    game.stats.stop_move_stats();
+    engine->game.stats.stop_move_stats();
+
+    // See if the search didn't choose a move. The search without negamax only takes
+    // a move that is better than the worst value, so that happens when every move
+    // loses, and when the search ran out of time first. The first legal move is made
+    // then. It is only checkmate or stalemate when there are no legal moves.
+    if (!engine->game.supply_valid && (-1 == (whites_turn ? wmove : bmove).from) && (PLAYING == engine->game.state)) {
+        if (!first_legal_move(whites_turn ? wmove : bmove)) {
+            if (king_in_check(engine->game.turn)) {
+                engine->game.state = whites_turn ? BLACK_CHECKMATE : WHITE_CHECKMATE;
+            }
+            else {
+                engine->game.state = STALEMATE;
+            }
+        }
+    }
+
+    // See if the game is over
+    if (PLAYING != engine->game.state) {
+        return;
+    }
 
-    printf(Debug1, "\nMove #%d: ", game.move_num + 1);
+    printf(Debug1, "\nMove #%d: ", engine->game.move_num + 1);
 
     // If we have a user or a book move that's been validated then use it
-    if (game.supply_valid) {
-        (whites_turn ? wmove : bmove) = game.supplied;
-        game.last_move = game.supplied;
+    if (engine->game.supply_valid) {
+        (whites_turn ? wmove : bmove) = engine->game.supplied;
+        engine->game.last_move = engine->game.supplied;
 
-        if (game.book_supplied) {
+        if (engine->game.book_supplied) {
             printf(Debug1, "Book: ");
         }
 
-        if (game.user_supplied) {
+        if (engine->game.user_supplied) {
             printf(Debug1, "User: ");
         }
     }
@@ -1032,12 +2100,12 @@ void take_turn()
 
     // Save the number of pieces in the game before we make the move
     // in order to see if any pieces were taken
-    index_t const piece_count = game.piece_count;
+    index_t const piece_count = engine->game.piece_count;
 
     // Make the move:
     piece_gen_t gen(move, wmove, bmove, consider_move, False);
     gen.move = move;
-    gen.init(board, game);
+    gen.init(engine->board, engine->game);
 
     make_move(gen);
 
@@ -1045,43 +2113,53 @@ void take_turn()
     check_kings();
 
     // Check for move repetition
-    if ((PLAYING == game.state) && add_to_history(gen.move)) {
-        game.state = whites_turn ? WHITE_3_MOVE_REP : BLACK_3_MOVE_REP;
+    if ((PLAYING == engine->game.state) && add_to_history(gen.move)) {
+        engine->game.state = whites_turn ? WHITE_3_MOVE_REP : BLACK_3_MOVE_REP;
     }
 
-    if (game.last_was_en_passant) {
+    if (engine->game.last_was_en_passant) {
         printf(Debug1, " - en passant capture ");
     }
 
-    if (game.last_was_pawn_promotion) {
+    if (engine->game.last_was_pawn_promotion) {
         printf(Debug1, " - pawn promoted ");
     }
 
-    if (game.last_was_castle) {
+    if (engine->game.last_was_castle) {
         printf(Debug1, " - castling ");
     }
 
+    // Show the line of moves we expect to follow this one
+    if (engine->game.options.negamax && !engine->game.supply_valid && !is_human_turn) {
+        printf(Debug1, " ");
+        engine->pv.show();
+    }
+
     printnl(Debug1);
 
-    if (whites_turn && game.white_king_in_check) {
-        game.state = BLACK_CHECKMATE;
+    if (whites_turn && engine->game.white_king_in_check) {
+        engine->game.state = BLACK_CHECKMATE;
     }
 
-    if (!whites_turn && game.black_king_in_check) {
-        game.state = WHITE_CHECKMATE;
+    if (!whites_turn && engine->game.black_king_in_check) {
+        engine->game.state = WHITE_CHECKMATE;
     }
 
     // Toggle whose turn it is
-    game.turn = !game.turn;
+    engine->game.turn = !engine->game.turn;
+    engine->game.hash ^= zobrist(ZOB_SIDE);
 
     // Increase the game move counter
-    game.move_num++;
+    engine->game.move_num++;
 
     // Delete any soft-deleted pieces for real
-    if (piece_count != game.piece_count) {
-        for (index_t i = 0; i < game.piece_count; i++) {
-            if (game.pieces[i].x == -1) {
-                game.pieces[i] = game.pieces[--game.piece_count];
+    if (piece_count != engine->game.piece_count) {
+        for (index_t i = 0; i < engine->game.piece_count; i++) {
+            if (engine->game.pieces[i].x == -1) {
+                engine->game.pieces[i] = engine->game.pieces[--engine->game.piece_count];
+                if (-1 != engine->game.pieces[i].x) {
+                    engine->game.piece_map[engine->game.pieces[i].x + engine->game.pieces[i].y * 8] = i;
+                }
                 break;
             }
         }
@@ -1100,38 +2178,154 @@ void show_game_options() {
     printf(Always, "MIN/MAX: %s to %s\n", str2, str1);
 
     printf(Always, "Time limit: ");
-    if (0 == game.options.time_limit) {
+    if (0 == engine->game.options.time_limit) {
         printf(Always, "none\n");
     }
     else {
-        show_time(game.options.time_limit);
+        show_time(engine->game.options.time_limit);
         printnl(Always);
     }
 
     printf(Always, "PRNG Seed: 0x%04X%04X\n",
-        (game.options.seed >> 16),
-        word(game.options.seed));
+        (engine->game.options.seed >> 16),
+        word(engine->game.options.seed));
 
     printf(Always, "Plies: M: %d, N: %d, Q: %d, X: %d\n", 
-        game.options.minply,
-        game.options.maxply,
-        game.options.max_quiescent_ply,
-        game.options.max_max_ply);
+        engine->game.options.minply,
+        engine->game.options.maxply,
+        engine->game.options.max_quiescent_ply,
+        engine->game.options.max_max_ply);
 
-    printf(Always, "Max moves: %d\n", game.options.move_limit);
+    printf(Always, "Max moves: %d\n", engine->game.options.move_limit);
 
     printf(Always, "Alpha-Beta: ");
-    if (game.options.alpha_beta_pruning) {
+    if (engine->game.options.alpha_beta_pruning) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    #ifdef ENA_SMP
+    printf(Always, "Threads: %d", engine->game.options.threads);
+    if (engine->game.options.root_split) {
+        printf(Always, " (root split)");
+    }
+    printnl(Always);
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    if (0 != engine->game.options.selfplay_games) {
+        printf(Always, "Self-play: %ld games, %d threads\n",
+            engine->game.options.selfplay_games,
+            engine->game.options.selfplay_threads);
+    }
+    #endif
+
+    #ifdef ENA_MATCH
+    if (engine->game.options.match) {
+        printf(Always, "Match: A vs B, %d Elo test\n", engine->game.options.sprt_elo);
+    }
+    else if (engine->game.options.per_side) {
+        printf(Always, "Per-side options: y\n");
+    }
+    #endif
+
+    printf(Always, "Trans table: ");
+    if (engine->game.options.trans_table && (0 != engine->game.options.randskip)) {
+        printf(Always, "n (not used with Skip)\n");
+    }
+    else if (engine->game.options.trans_table) {
+        printf(Always, "y (%ld entries)\n", long(TT_ENTRIES));
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Iterative: ");
+    if (engine->game.options.iterative) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Negamax: ");
+    if (engine->game.options.negamax) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "PVS: ");
+    if (engine->game.options.pvs) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Quiescent: ");
+    if (engine->game.options.qsearch) {
+        printf(Always, "captures\n");
+    }
+    else {
+        printf(Always, "all moves\n");
+    }
+
+    printf(Always, "Legal moves: ");
+    if (engine->game.options.legal_moves) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Move order: ");
+    if (engine->game.options.move_order) {
+        printf(Always, "y\n");
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Move list: ");
+    #ifdef ENA_MOVE_LIST
+    if (engine->game.options.move_list) {
+        printf(Always, "y (%ld entries)\n", long(MOVE_STACK));
+    }
+    else {
+        printf(Always, "n\n");
+    }
+    #else
+    printf(Always, "n\n");
+    #endif
+
+    printf(Always, "Killers/history: ");
+    if (engine->game.options.quiet_order) {
+        #ifdef ENA_HISTORY
+        printf(Always, "y/y\n");
+        #else
+        printf(Always, "y/n\n");
+        #endif
+    }
+    else {
+        printf(Always, "n\n");
+    }
+
+    printf(Always, "Random ties: ");
+    if (engine->game.options.random_ties) {
         printf(Always, "y\n");
     }
     else {
         printf(Always, "n\n");
     }
 
-    printf(Always, "Mistakes: %d%%\n", game.options.mistakes);
+    printf(Always, "Mistakes: %d%%\n", engine->game.options.mistakes);
 
     printf(Always, "Integrate: ");
-    if (game.options.integrate) {
+    if (engine->game.options.integrate) {
         printf(Always, "y\n");
     }
     else {
@@ -1139,7 +2333,7 @@ void show_game_options() {
     }
 
     printf(Always, "Openings: ");
-    if (game.options.openbook) {
+    if (engine->game.options.openbook) {
         printf(Always, "y\n");
     }
     else {
@@ -1153,7 +2347,7 @@ void show_game_options() {
     #endif
 
     printf(Always, "Shuffle: ");
-    if (game.options.shuffle_pieces) {
+    if (engine->game.options.shuffle_pieces) {
         printf(Always, "y\n");
     }
     else {
@@ -1161,26 +2355,26 @@ void show_game_options() {
     }
 
     printf(Always, "Random: ");
-    if (game.options.random) {
+    if (engine->game.options.random) {
         printf(Always, "y\n");
     }
     else {
         printf(Always, "n\n");
     }
 
-    printf(Always, "Skip: %d%%\n", game.options.randskip);
+    printf(Always, "Skip: %d%%\n", engine->game.options.randskip);
 
     // Enable random seed when program is debugged.
     // Disable random seed to reproduce issues or to profile.
-    if (game.options.profiling) {
+    if (engine->game.options.profiling) {
         printf(Always, "\nProfiling:\n");
 
         // Turn off output if we are profiling
-        game.options.print_level = None;
+        engine->game.options.print_level = None;
     } 
     printnl(Always);
 
-    randomSeed(game.options.seed);
+    engine->seed(engine->game.options.seed);
 
 }   // show_game_options()
 
@@ -1190,73 +2384,176 @@ void show_game_options() {
 void set_game_options()
 {
 //  game.options.print_level = None;     // The verbosity setting for the level of output
-    game.options.print_level = Everything;
+    engine->game.options.print_level = Everything;
 
-    game.options.white_human = false;
-    game.options.black_human = false;
+    engine->game.options.white_human = false;
+    engine->game.options.black_human = false;
     
+    // Set game.options.benchmark to True to time a fixed search before playing
+    engine->game.options.benchmark = False;
+    // engine->game.options.benchmark = True;
+
     // Set game.options.profiling to True to disable output and profile the engine
-    game.options.profiling = False;
-    // game.options.profiling = True;
+    engine->game.options.profiling = False;
+    // engine->game.options.profiling = True;
 
     // Set the ultimate maximum ply level (incl)
-    game.options.max_max_ply = 2;
+    engine->game.options.max_max_ply = 2;
 
     // Set the max ply level (inclusive) for normal moves
-    game.options.maxply = 1;
+    engine->game.options.maxply = 1;
 
     // Set the minimum ply level required to complete for a turn
-    game.options.minply = 1;
+    engine->game.options.minply = 1;
 
     // Set the percentage of moves that might be a mistake
-    game.options.mistakes = 0;
+    engine->game.options.mistakes = 0;
 
     // Set whether weintegrate ply values or assume them
-    game.options.integrate = False;
-    // game.options.integrate = True;
+    engine->game.options.integrate = False;
+    // engine->game.options.integrate = True;
 
     // Set game.options.random to True to use randomness in the game decisions
-    // game.options.random = False;
-    game.options.random = True;
+    // engine->game.options.random = False;
+    engine->game.options.random = True;
 
     // Set the time limit per turn in milliseconds
     // game.options.time_limit = 0;     // for no time limit
-    game.options.time_limit = 10000;
+    engine->game.options.time_limit = 10000;
 
     // Set whether we play continuously or not
-    // game.options.continuous = False;
-    game.options.continuous = True;
+    // engine->game.options.continuous = False;
+    engine->game.options.continuous = True;
 
     // Enable or disable alpha-beta pruning
-    // game.options.alpha_beta_pruning = False;
-    game.options.alpha_beta_pruning = True;
+    // engine->game.options.alpha_beta_pruning = False;
+    engine->game.options.alpha_beta_pruning = True;
 
     // When shuffle_pieces is True we shuffle the pieces[] array before each turn
     // so that we process the current side's pieces in random order.
-    // game.options.shuffle_pieces = False;
-    game.options.shuffle_pieces = True;
+    engine->game.options.shuffle_pieces = False;
+    // engine->game.options.shuffle_pieces = True;
+
+    // Search only captures and promotions past maxply, or all of the moves (used with negamax)
+    // engine->game.options.qsearch = False;
+    engine->game.options.qsearch = True;
+
+    // Generate only the legal moves for the side to move
+    // engine->game.options.legal_moves = False;
+    engine->game.options.legal_moves = True;
+
+    // Search the best move from before, then captures and promotions, then quiet moves
+    // engine->game.options.move_order = False;
+    engine->game.options.move_order = True;
+
+    // Generate each node's moves onto the move stack and search them by their scores.
+    // Without ENA_MOVE_LIST (AVR) the smaller lists collected by move_order are used instead.
+    #ifdef ENA_MOVE_LIST
+    // engine->game.options.move_list = False;
+    engine->game.options.move_list = True;
+    #else
+    engine->game.options.move_list = False;
+    #endif
+
+    // Order the quiet moves using the killer moves and history counts
+    // engine->game.options.quiet_order = False;
+    engine->game.options.quiet_order = True;
+
+    // Choose between moves with equal values at random
+    engine->game.options.random_ties = False;
+    // engine->game.options.random_ties = True;
+
+    // Set the percentage of moves we randomly skip at ply depths > 1.
+    // The transposition table is only used when this is 0.
+    // engine->game.options.randskip = 0;
+    engine->game.options.randskip = 95;
+
+    // Enable or disable the transposition table
+    // engine->game.options.trans_table = False;
+    engine->game.options.trans_table = True;
+
+    // Enable or disable iterative deepening
+    // engine->game.options.iterative = False;
+    engine->game.options.iterative = True;
+
+    // Search only the side to move with negamax or both sides at every ply
+    // engine->game.options.negamax = False;
+    engine->game.options.negamax = True;
 
-    // Set the percentage of moves we randomly skip at ply depths > 1
-    // game.options.randskip = 0;
-    game.options.randskip = 95;
+    // Enable or disable principal variation search (used with negamax)
+    // engine->game.options.pvs = False;
+    engine->game.options.pvs = True;
 
     // Enable or disable opening book moves
-    // game.options.openbook = False;
-    game.options.openbook = True;
+    // engine->game.options.openbook = False;
+    engine->game.options.openbook = True;
 
     // Set the maximum ply level to continue if a move takes a piece
-    // The quiescent search depth is based off of the max ply level
-    game.options.max_quiescent_ply = min((long) game.options.maxply + 1, (long) game.options.max_max_ply);
+    // The quiescent search depth is based off of the max ply level.
+    // The qsearch used with negamax continues up to max_max_ply instead.
+    engine->game.options.max_quiescent_ply = min((long) engine->game.options.maxply + 1, (long) engine->game.options.max_max_ply);
 
     // set the 'live update' flag
-    // game.options.live_update = False;
-    game.options.live_update = True;
+    // engine->game.options.live_update = False;
+    engine->game.options.live_update = True;
+
+    #ifdef ENA_SMP
+    // Set the number of threads that search each move together using Lazy SMP
+    engine->game.options.threads = 1;
+    // engine->game.options.threads = 4;
+
+    // Share the root moves out between the threads instead of using Lazy SMP.
+    // The moves chosen are the same however the threads are scheduled.
+    engine->game.options.root_split = False;
+    // engine->game.options.root_split = True;
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    // Set the number of games to play against itself on more than one thread
+    // instead of playing one game at a time
+    engine->game.options.selfplay_games = 0;
+    // engine->game.options.selfplay_games = 10000;
+
+    // Set the number of threads playing the self-play games
+    engine->game.options.selfplay_threads = 1;
+    // engine->game.options.selfplay_threads = 8;
+    #endif
+
+    #ifdef ENA_MATCH
+    // Set the options that White and Black each search with on their own turns.
+    // They both start out the same as the options above.
+    engine->game.options.get_side(engine->game.options.sides[White]);
+    engine->game.options.get_side(engine->game.options.sides[Black]);
+    // engine->game.options.sides[Black].maxply = 1;
+    // engine->game.options.sides[Black].mobilityBonus = 0;
+
+    // Search with each side's own options
+    engine->game.options.per_side = False;
+    // engine->game.options.per_side = True;
+
+    // Play a match between White's options (A) and Black's options (B) that
+    // alternates colors, and stop when A is shown to be stronger or weaker
+    // than B by sprt_elo Elo
+    engine->game.options.match = False;
+    // engine->game.options.match = True;
+    engine->game.options.sprt_elo = 20;
+    #endif
 
     // game seed hash for PRN generator - default to 4 hex prime numbers
-    game.options.seed = 0x232F89A3;
+    engine->game.options.seed = 0x232F89A3;
+
+    #ifdef ENA_FIXED_CONFIG
+    // The search is compiled with the fixed_config_t features so show those
+    engine->game.options.alpha_beta_pruning = fixed_config_t::alpha_beta_pruning();
+    engine->game.options.integrate = fixed_config_t::integrate();
+    engine->game.options.random_ties = fixed_config_t::random_ties();
+    engine->game.options.live_update = fixed_config_t::live_update();
+    engine->game.options.mistakes = fixed_config_t::mistakes();
+    engine->game.options.randskip = fixed_config_t::randskip();
+    #endif
 
     // Salt the psuedo-random number generator seed if enabled:
-    if (game.options.random) {
+    if (engine->game.options.random) {
         // Add salt to the psuedo random number generator seed
         // from the physical environment
         uint8_t const pins[] = { 2, 7, 9, 10, 11, 12 };
@@ -1275,8 +2572,8 @@ void set_game_options()
         #endif
             }
         }
-        uint8_t bits = (game.options.seed >> 11) & 0xFF;
-        game.options.seed += 
+        uint8_t bits = (engine->game.options.seed >> 11) & 0xFF;
+        engine->game.options.seed += 
             bits +
         #ifndef ESP32
         (uint32_t(analogRead(A0)) << 24) +
@@ -1293,7 +2590,7 @@ void set_game_options()
         #endif
             uint32_t(micros());
 
-        game.options.seed += some_bits;        
+        engine->game.options.seed += some_bits;        
     }
 
 }   // set_game_options()
@@ -1360,67 +2657,103 @@ void setup()
     #endif
 
     // Initialize the continuous game statistics
-    uint32_t state_totals[6] = { 0, 0, 0, 0, 0, 0 };
-    uint32_t white_wins = 0;
-    uint32_t black_wins = 0;
+    results_t results;
+
+    #ifdef ENA_MAGIC
+    // Build the sliding piece attack tables
+    magic.init();
+    #endif
 
     set_game_options();
     delay(1000);
     show_game_options();
 
+    if (engine->game.options.benchmark) {
+        benchmark();
+    }
+
+    #ifdef ENA_MATCH
+    // Remember the options being played against each other
+    if (engine->game.options.match) {
+        match.init(engine->game.options);
+    }
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    // Play the self-play games on their threads and show how they ended
+    if (0 != engine->game.options.selfplay_games) {
+        selfplay.run();
+        return;
+    }
+    #endif
+
     // Play a game until it is over
     do {
         set_game_options();
 
+        #ifdef ENA_MATCH
+        // Give A and B their colors for the next game of the match
+        if (engine->game.options.match) {
+            match.setup_game(engine->game.options, match.games());
+        }
+        #endif
+
         // set up a particular game board to test:
-        // board.clear();
-        // board.set(7 + 0 * 8u, King);
-        // board.set(3 + 3 * 8u, Queen);
-        // board.set(4 + 4 * 8u, King | Side);
-        // board.set(0 + 7 * 8u, Queen | Side);
-        // game.init();
+        // engine->board.clear();
+        // engine->board.set(7 + 0 * 8u, King);
+        // engine->board.set(3 + 3 * 8u, Queen);
+        // engine->board.set(4 + 4 * 8u, King | Side);
+        // engine->board.set(0 + 7 * 8u, Queen | Side);
+        // engine->game.init();
 
         // initialize the board and the game:
-         board.init();
-         game.init();
+        engine->init();
+        engine->tt().clear();
+        #ifdef ENA_SMP
+        smp.init();
+        #endif
 
         // Shuffle our pieces really well so we evaluate them in a random order
-        game.sort_pieces(game.turn);
-        game.shuffle_pieces(SHUFFLE);
+        if (engine->game.options.shuffle_pieces) {
+            engine->game.sort_pieces(engine->game.turn);
+            engine->game.shuffle_pieces(SHUFFLE);
+        }
 
         show_check_status();
         show();
 
-        game.stats.start_game_stats();
+        engine->game.stats.start_game_stats();
 
         do {
             take_turn();
-            if (PLAYING == game.state) {
+            if (PLAYING == engine->game.state) {
                 show_check_status();
                 show();
             }
 
-            if (!game.compare_pieces_to_board(board)) {
-                // printf(Debug1, "Error: game.pieces[] contents are different from the board contents\n");
-                game.set_pieces_from_board(board);
+            #ifdef ENA_PIECE_CHECK
+            if (!engine->game.compare_pieces_to_board(engine->board)) {
+                printf(Always, "piece list mismatch: move %d\n", engine->game.move_num);
+                engine->game.set_pieces_from_board(engine->board);
             }
+            #endif
 
-        } while (PLAYING == game.state);
+        } while (PLAYING == engine->game.state);
 
         // Calculate the game statistics
-        game.stats.stop_game_stats();
+        engine->game.stats.stop_game_stats();
 
         // Return the output to normal
-        game.options.print_level = Debug1;
+        engine->game.options.print_level = Debug1;
 
         // Display the end game reason
-        switch (game.state) {
+        switch (engine->game.state) {
             case STALEMATE:         printf(Debug1, "Stalemate\n\n");                                        break;
             case WHITE_CHECKMATE:   printf(Debug1, "Checkmate! White wins!\n\n");                           break;
             case BLACK_CHECKMATE:   printf(Debug1, "Checkmate! Black wins!\n\n");                           break;
             case WHITE_3_MOVE_REP:  printf(Debug1, "%d-move repetition! Black wins!\n\n", MAX_REPS);        break;
             case BLACK_3_MOVE_REP:  printf(Debug1, "%d-move repetition! White wins!\n\n", MAX_REPS);        break;
-            case MOVE_LIMIT:        printf(Debug1, "%d-move limit reached!\n\n", game.options.move_limit);  break;
+            case MOVE_LIMIT:        printf(Debug1, "%d-move limit reached!\n\n", engine->game.options.move_limit);  break;
             default: 
             case PLAYING:           break;
         }
@@ -1432,53 +2765,26 @@ void setup()
         show_stats();
 
         // Keep track of the game end reasons when playing continuously
-        state_totals[game.state - 1]++;
-        char str[16] = "";
-
-        printf(Debug1, "         Stalemate   White Checkmate   Black Checkmate  White %d-Move Rep  Black %d-Move Rep        Move Limit\n", 
-            MAX_REPS, MAX_REPS);
-        
-        ftostr(state_totals[       STALEMATE - 1], 0, str);
-        printf(Debug1, "%18s", str);
-        ftostr(state_totals[ WHITE_CHECKMATE - 1], 0, str);
-        printf(Debug1, "%18s", str);
-        ftostr(state_totals[ BLACK_CHECKMATE - 1], 0, str);
-        printf(Debug1, "%18s", str);
-        ftostr(state_totals[WHITE_3_MOVE_REP - 1], 0, str);
-        printf(Debug1, "%18s", str);
-        ftostr(state_totals[BLACK_3_MOVE_REP - 1], 0, str);
-        printf(Debug1, "%18s", str);
-        ftostr(state_totals[     MOVE_LIMIT - 1], 0, str);
-        printf(Debug1, "%18s", str);
-
-        printnl(Debug1);
-
-        switch (game.state) {
-            default:
-            case PLAYING:
-            case STALEMATE:
-            case MOVE_LIMIT:
-                break;
-
-            case WHITE_CHECKMATE:
-            case BLACK_3_MOVE_REP:
-                white_wins++;
-                break;
-
-            case BLACK_CHECKMATE:
-            case WHITE_3_MOVE_REP:
-                black_wins++;
+        results.add(state_t(engine->game.state));
+        results.show();
+
+        #ifdef ENA_MATCH
+        // Stop the match as soon as it is known which options are stronger
+        if (engine->game.options.match) {
+            match.add(state_t(engine->game.state), match.games());
+            match.show();
+            if (0 != match.result()) {
                 break;
+            }
         }
+        #endif
 
-        printf(Debug1, "   White wins: %3ld   Black wins: %3ld\n\n", white_wins, black_wins);
-
-        if (game.options.profiling) {
+        if (engine->game.options.profiling) {
             // Return to no output when profiling
-            game.options.print_level = None;
+            engine->game.options.print_level = None;
         }
 
-    } while (game.options.continuous);
+    } while (engine->game.options.continuous);
 
 }   // setup()
 
@@ -1486,11 +2792,102 @@ void setup()
 void loop() {}
 
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Play the benchmark moves once from the starting position
+//
+// returns the moves evaluated by all of the threads and sets the ms it took
+static uint32_t bench_game(uint32_t &duration)
+{
+    uint32_t moves = 0;
+
+    engine->init();
+    engine->tt().clear();
+    #ifdef ENA_SMP
+    smp.init();
+    #endif
+
+    uint32_t const start = millis();
+    while ((engine->game.move_num < BENCH_MOVES) && (PLAYING == engine->game.state)) {
+        take_turn();
+        moves += engine->game.stats.move_stats.counter();
+    }
+    duration = millis() - start;
+
+    #ifdef ENA_SMP
+    moves += smp.helper_count();
+    #endif
+
+    return moves;
+
+}   // bench_game(uint32_t &duration)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Play the first BENCH_MOVES moves of a game from the starting position searching
+// BENCH_PLY plies deep with no time limit and nothing random, and show how many
+// moves were evaluated per second. The game options are set back when it is done.
+//
+// With ENA_SMP and more than one thread the same moves are played again with one
+// thread, then two, and so on up to game.options.threads, and the moves evaluated
+// per second for each are compared to the moves evaluated per second with one.
+void benchmark()
+{
+    uint32_t moves, duration;
+    uint32_t single = 0;
+    index_t threads = 1;
+    char str[16] = "";
+
+    #ifdef ENA_SMP
+    threads = max(1L, min((long) engine->game.options.threads, (long) MAX_THREADS));
+    #endif
+
+    engine->game.options.print_level = None;
+    engine->game.options.maxply = BENCH_PLY;
+    engine->game.options.max_max_ply = BENCH_PLY + 2;
+    engine->game.options.max_quiescent_ply = BENCH_PLY + 2;
+    engine->game.options.time_limit = 0;
+    engine->game.options.random = False;
+    engine->game.options.randskip = 0;
+    engine->game.options.openbook = False;
+    engine->game.options.live_update = False;
+
+    for (index_t count = 1; count <= threads; count++) {
+        #ifdef ENA_SMP
+        engine->game.options.threads = count;
+        #endif
+
+        moves = bench_game(duration);
+        uint32_t const moveps = (0 == duration) ? 0 : uint32_t(uint64_t(moves) * 1000 / duration);
+
+        printf(Always, "Benchmark: %d moves at ply %d", engine->game.move_num, BENCH_PLY);
+        if (threads > 1) {
+            printf(Always, " with %d thread%s", count, (1 == count) ? "" : "s");
+        }
+        printf(Always, ", %ld moves evaluated in %ld ms", long(moves), long(duration));
+        if (0 != duration) {
+            printf(Always, " (%ld moves/sec", long(moveps));
+            if (1 == count) {
+                single = max(1UL, (unsigned long) moveps);
+            }
+            else if (0 != single) {
+                ftostr(double(moveps) / single, 2, str);
+                printf(Always, ", %sx one thread", str);
+            }
+            printf(Always, ")");
+        }
+        printnl(Always);
+    }
+
+    set_game_options();
+
+}   // benchmark()
+
+
 /// Board display functions
 
 void show_header(Bool const dev) {
-    if (Debug1 >= game.options.print_level) {
-        Serial.write((game.piece_count <= END_COUNT) ? '+' : ' ');
+    if (Debug1 >= engine->game.options.print_level) {
+        Serial.write((engine->game.piece_count <= END_COUNT) ? '+' : ' ');
         char const base = (dev ? '0' : 'A');
         for (index_t i = 0; i < 8; i++) {
             printrep(Debug1, ' ', 2);
@@ -1517,54 +2914,54 @@ void show_panel1(index_t const y) {
     switch (y) {
         // display the last move made if available
         case row_offset + 0:
-            if (game.last_move.from != -1 && game.last_move.to != -1) {
+            if (engine->game.last_move.from != -1 && engine->game.last_move.to != -1) {
                 printf(Debug1, "Last Move: %c%c to %c%c", 
-                    (game.last_move.from % 8) + 'A', 
-                    '8' - (game.last_move.from / 8), 
-                    (game.last_move.to   % 8) + 'A', 
-                    '8' - (game.last_move.to   / 8) );
+                    (engine->game.last_move.from % 8) + 'A', 
+                    '8' - (engine->game.last_move.from / 8), 
+                    (engine->game.last_move.to   % 8) + 'A', 
+                    '8' - (engine->game.last_move.to   / 8) );
             }
             break;
 
         // Display the time spent on the last move
         case row_offset + 1:
-            if (0 == game.stats.move_stats.duration()) break;
-            if (0 != game.stats.move_stats.counter()) {
-                ftostr(game.stats.move_stats.counter(), 0, str);
+            if (0 == engine->game.stats.move_stats.duration()) break;
+            if (0 != engine->game.stats.move_stats.counter()) {
+                ftostr(engine->game.stats.move_stats.counter(), 0, str);
                 printf(Debug1, "%s moves in ", str);
 
-                show_time(game.stats.move_stats.duration());
+                show_time(engine->game.stats.move_stats.duration());
 
-                ftostr(game.stats.move_stats.moveps(), 2, str);
+                ftostr(engine->game.stats.move_stats.moveps(), 2, str);
                 printf(Debug1, " (%s moves/sec)", str);
             }
             break;
 
         // Display the total game time so far
         case row_offset + 2:
-            if (game.move_num > 0) {
+            if (engine->game.move_num > 0) {
                 printf(Debug1, "Game time: ");
-                show_time(game.stats.game_stats.duration());
+                show_time(engine->game.stats.game_stats.duration());
             }
             break;
 
         // Display the max ply depth we were able to reach
         case row_offset + 3:
-            if (game.move_num > 0) {
-                printf(Debug1, "Max ply depth reached: %d", game.stats.move_stats.depth);
+            if (engine->game.move_num > 0) {
+                printf(Debug1, "Max ply depth reached: %d", engine->game.stats.move_stats.depth);
             }
             break;
 
         // Display the check state for White
         case row_offset + 4:
-            if (game.white_king_in_check) {
+            if (engine->game.white_king_in_check) {
                 show_check(White);
             }
             break;
 
         // Display the check state for Black
         case row_offset + 5:
-            if (game.black_king_in_check) {
+            if (engine->game.black_king_in_check) {
                 show_check(Black);
             }
             break;
@@ -1572,8 +2969,8 @@ void show_panel1(index_t const y) {
         // Display the pieces taken by White
         case row_offset + 6:
             printf(Debug1, "Taken 1: ");
-            for (index_t i = 0; i < game.white_taken_count; i++) {
-                piece = game.taken_by_white[i].piece;
+            for (index_t i = 0; i < engine->game.white_taken_count; i++) {
+                piece = engine->game.taken_by_white[i].piece;
                 ptype = getType(piece);
                 pside = getSide(piece);
                 printf(Debug1, "%c ", pgm_read_byte(&icons[(pside * 6) + ptype - 1]));
@@ -1583,8 +2980,8 @@ void show_panel1(index_t const y) {
         // Display the pieces taken by Black
         case row_offset + 7:
             printf(Debug1, "Taken 2: ");
-            for (index_t i = 0; i < game.black_taken_count; i++) {
-                piece = game.taken_by_black[i].piece;
+            for (index_t i = 0; i < engine->game.black_taken_count; i++) {
+                piece = engine->game.taken_by_black[i].piece;
                 ptype = getType(piece);
                 pside = getSide(piece);
                 printf(Debug1, "%c ", pgm_read_byte(&icons[(pside * 6) + ptype - 1]));
@@ -1599,7 +2996,7 @@ void show()
 {
     static Bool constexpr dev = True;
 
-    if (game.options.print_level < Debug1) { return; }
+    if (engine->game.options.print_level < Debug1) { return; }
 
     show_header(!dev);
     printnl(Debug1);
@@ -1607,7 +3004,7 @@ void show()
     for (unsigned char y = 0; y < 8u; ++y) {
         printf(Debug1, "%c ", dev ? ('0' + y) : ('8' - y));
         for (unsigned char x = 0; x < 8u; ++x) {
-            Piece const piece = board.get(y * 8u + x);
+            Piece const piece = engine->board.get(y * 8u + x);
             printf(Debug1, " %c ", 
                 isEmpty(piece) ? ((y ^ x) & 1 ? '*' : '.') :
                 pgm_read_byte(&icons[((getSide(piece) * 6) + getType(piece) - 1)]));
@@ -1623,11 +3020,11 @@ void show()
     show_header(dev);
 
     char str_score[16] = "";
-    ftostr(game.last_move.value, 0, str_score);
+    ftostr(engine->game.last_move.value, 0, str_score);
     printrep(Debug1, ' ', 9);
     printf(Debug1, "Board value: %s ", str_score);
-    if (0 != game.last_move.value) {
-        show_side(game.last_move.value > 0);
+    if (0 != engine->game.last_move.value) {
+        show_side(engine->game.last_move.value > 0);
         printf(Debug1, "'s favor");
     }
 
@@ -39,15 +39,3 @@ void board_t::init() {
     }
 
 } // board_t::init()
-
-
-
-Piece board_t::get(unsigned char index) const
-{
-    return board.get(index);
-}
-
-void board_t::set(unsigned char index, Piece const piece) 
-{
-    board.set(index, piece);
-}
\ No newline at end of file
@@ -196,9 +196,65 @@ class board_t2 {
 };  // board_t2
 
 
+// The bitboard backend keeps the spots holding each Piece type and each side as
+// one bit per spot (col + row * 8), along with the whole Piece for each spot so
+// that get() is a single read. The Moved and Check flags are only kept in spots[].
+class board_t3 {
+    private:
+    Piece     spots[64];
+    uint64_t  types[8];     // The spots holding each Piece type. types[Empty] is never used
+    uint64_t  sides[2];     // The spots holding each side's pieces
+    uint64_t  occupied;     // The spots holding any piece
+
+    public:
+    Piece get(unsigned char index) const 
+    {
+        return spots[index];
+    }
+
+    void set(unsigned char index, Piece const piece) 
+    {
+        uint64_t const bit = 1ULL << index;
+        Piece const old = spots[index];
+
+        types[getType(old)] &= ~bit;
+        sides[getSide(old)] &= ~bit;
+        occupied &= ~bit;
+
+        spots[index] = piece;
+
+        if (Empty != getType(piece)) {
+            types[getType(piece)] |= bit;
+            sides[getSide(piece)] |= bit;
+            occupied |= bit;
+        }
+    }
+
+    uint64_t pieces(Piece const type, Color const side) const
+    {
+        return types[type] & sides[side];
+    }
+
+    uint64_t side(Color const side) const
+    {
+        return sides[side];
+    }
+
+    uint64_t all() const
+    {
+        return occupied;
+    }
+
+};  // board_t3
+
+
 class board_t {
     private:
+    #ifdef ENA_BITBOARD
+    board_t3  board;
+    #else
     board_t2  board;
+    #endif
 
     public:
     board_t();
@@ -207,9 +263,33 @@ class board_t {
 
     void clear();
 
-    Piece get(unsigned char index) const;
+    Piece get(unsigned char index) const
+    {
+        return board.get(index);
+    }
 
-    void set(unsigned char index, Piece const piece);
+    void set(unsigned char index, Piece const piece)
+    {
+        board.set(index, piece);
+    }
+
+    #ifdef ENA_BITBOARD
+    // The spots holding a side's pieces of one type, all of a side's pieces, or every piece
+    uint64_t pieces(Piece const type, Color const side) const
+    {
+        return board.pieces(type, side);
+    }
+
+    uint64_t side(Color const side) const
+    {
+        return board.side(side);
+    }
+
+    uint64_t occupied() const
+    {
+        return board.all();
+    }
+    #endif
 
 };  // board_t
 
@@ -19,8 +19,6 @@
 #include <stdint.h>
 
 
-extern game_t  game;
-
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Opening book moves (if enabled)
@@ -39,7 +37,7 @@ piece_gen_t::piece_gen_t(move_t &m) :
     move(m),
     wbest(m),
     bbest(m) {
-    init(board, game);
+    init(engine->board, engine->game);
 }
 
 
@@ -49,21 +47,27 @@ piece_gen_t::piece_gen_t(move_t &m, move_t &wb, move_t &bb, generator_t *cb, Boo
     bbest(bb),
     callme(cb),
     evaluating(eval) {
-    init(board, game);
+    init(engine->board, engine->game);
 }
 
 
 void /*inline*/ piece_gen_t::init(board_t const &board, game_t const &game) {
-    piece = board.get(move.from);
+    // choose_best_moves(...) starts with no move and sets up each piece itself
+    piece = (-1 == move.from) ? Empty : board.get(move.from);
     type = getType(piece);
     side = getSide(piece);
     col = move.from % 8;
     row = move.from / 8;
-    piece_index = game.find_piece(move.from);
+    piece_index = (-1 == move.from) ? -1 : game.find_piece(move.from);
     whites_turn = side;     // same as (White == side)
     cutoff = False;
     num_wmoves = 0;
     num_bmoves = 0;
+    alpha = MIN_VALUE;
+    beta = MAX_VALUE;
+    follow_pv = False;
+    order = nullptr;
+    legal = nullptr;
 }
 
 
@@ -157,7 +161,12 @@ Piece makeSpot(Piece type, Piece side, unsigned char moved, unsigned char inChec
 
 
 char * addCommas(long int value) {
+    // The threads playing their own games each format into their own buffer
+    #ifdef ENA_ENGINES
+    static thread_local char buff[16];
+    #else
     static char buff[16];
+    #endif
     snprintf(buff, sizeof(buff), "%ld", value);
 
     int start_idx = (buff[0] == '-') ? 1 : 0;
@@ -173,7 +182,7 @@ char * addCommas(long int value) {
 
 // repeat printing a character a number of times
 void printrep(print_t const level, char const c, index_t repeat) {
-    if (game.options.print_level < level) { return; }
+    if (engine->game.options.print_level < level) { return; }
     while (repeat--) {
         Serial.write(c);
     }
@@ -217,7 +226,11 @@ char *dtostrf (double val, signed char width, unsigned char prec, char *sout) {
 // adding commas to the resulting string to delineate thousands positions.
 char * ftostr(double const value, int const dec, char * const buff)
 {
+    #ifdef ENA_ENGINES
+    static thread_local char str[16];
+    #else
     static char str[16];
+    #endif
     dtostrf(value, sizeof(str), dec, str);
     char *p = str;
     while (isspace(*p)) p++;
@@ -235,9 +248,18 @@ char * ftostr(double const value, int const dec, char * const buff)
 
 // Check for a timeout during a turn
 Bool timeout() {
-    if (0 == game.options.time_limit) {
-        game.timeout1 = False;
-        game.timeout2 = False;
+    #ifdef ENA_SMP
+    // A helper thread stops as soon as the main thread has its moves
+    if (engine->helper && smp.stopped()) {
+        engine->game.timeout1 = True;
+        engine->game.timeout2 = True;
+        return True;
+    }
+    #endif
+
+    if (0 == engine->game.options.time_limit) {
+        engine->game.timeout1 = False;
+        engine->game.timeout2 = False;
         return False;
     }
 
@@ -249,7 +271,7 @@ Bool timeout() {
     // side to determine if the king is in check after the initial move.
 
     // Set the true timeout flag regardless of ply level
-    game.timeout2 = game.stats.move_stats.duration() >= game.options.time_limit;
+    engine->game.timeout2 = engine->game.stats.move_stats.duration() >= engine->game.options.time_limit;
 
     // Set the other timeout flag ONLY if we are above ply level 1*
     // NOTE: in order to truly set the game.white_king_in_check or the
@@ -260,13 +282,13 @@ Bool timeout() {
     // from being made that place a king in check. So we must allow both ply
     // level 0 and 1 to complete before we allow a timeout to stop the
     // evaluations:
-    game.timeout1 = game.timeout2 && (game.ply > game.options.minply);
+    engine->game.timeout1 = engine->game.timeout2 && (engine->game.ply > engine->game.options.minply);
 
-    if (game.timeout2) {
+    if (engine->game.timeout2) {
         show_timeout();
     }
 
-    return game.timeout1;
+    return engine->game.timeout1;
 
 } // timeout()
 
@@ -277,16 +299,26 @@ Bool check_mem(index_t const
     level
     #endif
     ) {
+    // freeMemory() measures the main thread's stack. The other threads have
+    // stacks of their own so there is nothing to check for them.
+    #ifdef ENA_SMP
+    if (engine->helper) { return False; }
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    if (engine->player) { return False; }
+    #endif
+
     #ifdef ENA_MEM_STATS
-    if ((unsigned int)freeMemory() < game.lowest_mem) {
-        game.lowest_mem = freeMemory();
-        game.lowest_mem_ply = game.ply;
+    if ((unsigned int)freeMemory() < engine->game.lowest_mem) {
+        engine->game.lowest_mem = freeMemory();
+        engine->game.lowest_mem_ply = engine->game.ply;
     }
 
-    game.freemem[level][game.ply].mem = freeMemory();
+    engine->game.freemem[level][engine->game.ply].mem = freeMemory();
     #endif
 
-    Bool const low_mem = freeMemory() < game.options.low_mem_limit;
+    Bool const low_mem = freeMemory() < engine->game.options.low_mem_limit;
     if (low_mem) {
         show_low_memory();
     }
@@ -343,81 +375,20 @@ void direct_write(index_t const pin, Bool const value) {
 void direct_write(index_t const /* pin */, Bool const /* value */) { }
 #endif
 
-#if 0
-
+// Set the game.white_king_in_check and game.black_king_in_check flags
 void check_kings() {
-    game.white_king_in_check = inCheck(board.get(game.wking));
-    game.black_king_in_check = inCheck(board.get(game.bking));
-}
-
-#else
+    engine->game.white_king_in_check = is_square_attacked(engine->game.wking, Black);
+    engine->game.black_king_in_check = is_square_attacked(engine->game.bking, White);
 
-// Static function used to implement the visitor-pattern
-// when checking for either king's check state
-static void visitor(piece_gen_t &gen) {
-    Piece const piece = board.get(gen.move.to);
-    if (King == getType(piece)) {
-        // This is a King; See which side it belongs to
-        if (White == getSide(piece)) {
-            game.white_king_in_check = True;
-        }
-        else {
-            game.black_king_in_check = True;
-        }
-    }
-}
-
-
-// Enumerate over all available moves and set the game.white_king_in_check
-// and game.black_king_in_check flags accordingly
-void check_kings() {
-    // Bool const wcheck = inCheck(board.get(game.wking));
-    // Bool const bcheck = inCheck(board.get(game.bking));
-
-    game.white_king_in_check = False;
-    game.black_king_in_check = False;
-
-    // Walk through the game.pieces[] list and set the king-in-check flags if necessary
-    for (index_t i = 0; i < game.piece_count; i++) {
-        if (-1 == game.pieces[i].x) { continue; }
-
-        // Construct a move_t object with the starting location
-        move_t move = { index_t(game.pieces[i].x + game.pieces[i].y * 8), -1, 0 };
-        piece_gen_t gen(move, move, move, visitor, False);
-        gen.move.value = gen.whites_turn ? MIN_VALUE : MAX_VALUE;
-
-        if (Empty == gen.type) { continue; }
-
-        // Evaluate the moves for this Piece Type and get the highest value move
-        switch (gen.type) {
-            case   Pawn:    add_pawn_moves(gen);    break;
-            case Knight:    add_knight_moves(gen);  break;
-            case Bishop:    add_bishop_moves(gen);  break;
-            case   Rook:    add_rook_moves(gen);    break;
-            case  Queen:    add_queen_moves(gen);   break;
-            case   King:    add_king_moves(gen);    break;
-            default: printf(Always, "bad type: line %d\n", __LINE__);   break;
-        }
-
-        // If both king's are in check then there's nothing else for us to do
-        if (game.white_king_in_check && game.black_king_in_check) {
-            // if (wcheck != game.white_king_in_check || bcheck != game.black_king_in_check) {
-            //     printf(Debug1, "check mismatch at line %d\n", __LINE__);
-            //     while (1) {}
-            // }
-            return;
-        }
-
-    } // for each piece on both sides
+} // check_kings()
 
-    // if (wcheck != game.white_king_in_check || bcheck != game.black_king_in_check) {
-    //     printf(Debug1, "check mismatch at line %d\n", __LINE__);
-    //     while (1) {}
-    // }
 
-} // check_kings()
+// See if a side's King is in check without changing the
+// game.white_king_in_check and game.black_king_in_check flags
+Bool king_in_check(Color const side) {
+    return is_square_attacked((White == side) ? engine->game.wking : engine->game.bking, !side);
 
-#endif
+} // king_in_check(Color const side)
 
 void show_low_memory() {
     direct_write(DEBUG1_PIN, HIGH);
@@ -451,14 +422,14 @@ void show_memory_stats1() {
 
     printf(Debug1, "== Memory Usage By Function and Ply Levels ==\n");
 
-    for (index_t i = 0; i <= game.options.max_max_ply; i++) {
-        printf(Debug1, "freemem[choose_best_move][ply %d] = %4d\n", i, game.freemem[CHOOSE][i].mem - prg_ram);
-        printf(Debug1, "freemem[ piece move gen ][ply %d] = %4d\n", i, game.freemem[ADD_MOVES][i].mem - prg_ram);
-        printf(Debug1, "freemem[ consider_move  ][ply %d] = %4d\n", i, game.freemem[CONSIDER][i].mem - prg_ram);
+    for (index_t i = 0; i <= engine->game.options.max_max_ply; i++) {
+        printf(Debug1, "freemem[choose_best_move][ply %d] = %4d\n", i, engine->game.freemem[CHOOSE][i].mem - prg_ram);
+        printf(Debug1, "freemem[ piece move gen ][ply %d] = %4d\n", i, engine->game.freemem[ADD_MOVES][i].mem - prg_ram);
+        printf(Debug1, "freemem[ consider_move  ][ply %d] = %4d\n", i, engine->game.freemem[CONSIDER][i].mem - prg_ram);
         printf(Debug1, "freemem[    make_move   ][ply %d] = %4d. Diff = %d\n", 
             i, 
-            game.freemem[MAKE][i].mem   - prg_ram, 
-            game.freemem[CHOOSE][i].mem - game.freemem[MAKE][i].mem);
+            engine->game.freemem[MAKE][i].mem   - prg_ram, 
+            engine->game.freemem[CHOOSE][i].mem - engine->game.freemem[MAKE][i].mem);
     
         printnl(Debug1);
     }
@@ -474,10 +445,10 @@ void show_memory_stats2() {
 
     printf(Debug1, "== Memory Usage By Function and Ply Levels ==\n");
 
-    int const choose_best_move_mem = game.freemem[CHOOSE][0].mem    - game.freemem[ADD_MOVES][0].mem;
-    int const piece_move_mem       = game.freemem[ADD_MOVES][0].mem - game.freemem[CONSIDER][0].mem;
-    int const consider_move_mem    = game.freemem[CONSIDER][0].mem  - game.freemem[MAKE][0].mem;
-    int const make_move_mem        = game.freemem[MAKE][0].mem      - game.freemem[CHOOSE][1].mem;
+    int const choose_best_move_mem = engine->game.freemem[CHOOSE][0].mem    - engine->game.freemem[ADD_MOVES][0].mem;
+    int const piece_move_mem       = engine->game.freemem[ADD_MOVES][0].mem - engine->game.freemem[CONSIDER][0].mem;
+    int const consider_move_mem    = engine->game.freemem[CONSIDER][0].mem  - engine->game.freemem[MAKE][0].mem;
+    int const make_move_mem        = engine->game.freemem[MAKE][0].mem      - engine->game.freemem[CHOOSE][1].mem;
 
     printf(Debug1, "choose_best_move(...) memory:   %3d\n", choose_best_move_mem);
     printf(Debug1, "      pieces_gen(...) memory: + %3d\n", piece_move_mem);
@@ -494,7 +465,7 @@ void show_memory_stats2() {
     printf(Debug1, "%d\n", recurs_mem);
     printrep(Debug1, ' ', 7);
     printf(Debug1, "Total Recusive Memory: %d\n", recurs_mem);
-    printf(Debug1, "    Lowest Memory Registered: %4d at ply level %d\n", game.lowest_mem - prg_ram, game.lowest_mem_ply);
+    printf(Debug1, "    Lowest Memory Registered: %4d at ply level %d\n", engine->game.lowest_mem - prg_ram, engine->game.lowest_mem_ply);
     printnl(Debug1);
 
 } // show_memory_stats2()
@@ -510,22 +481,22 @@ void show_stats() {
     printnl(Debug1);
     printrep(Debug1, ' ', 11);
     printf(Debug1, "total game time: ");
-    show_time(game.stats.game_stats.duration());
+    show_time(engine->game.stats.game_stats.duration());
     printnl(Debug1);
 
-    uint32_t const move_count = game.move_num;
+    uint32_t const move_count = engine->game.move_num;
     ftostr(move_count, 0, str);
     printrep(Debug1, ' ', 11);
     printf(Debug1, "number of moves: %s\n", str);
 
-    uint32_t const game_count = game.stats.game_stats.counter();
+    uint32_t const game_count = engine->game.stats.game_stats.counter();
     ftostr(game_count, 0, str);
     printf(Debug1, "total game moves evaluated: %s\n", str);
 
-    uint32_t const moves_per_sec = game.stats.game_stats.moveps();
+    uint32_t const moves_per_sec = engine->game.stats.game_stats.moveps();
     ftostr(moves_per_sec, 0, str);
     printf(Debug1, "  average moves per second: %s %s\n", str, 
-        game.options.profiling ? "" : "(this includes waiting on the serial output)");
+        engine->game.options.profiling ? "" : "(this includes waiting on the serial output)");
 
     #ifdef ENA_MEM_STATS
     show_memory_stats2();
@@ -555,6 +526,16 @@ Bool check_serial()
 
     moved = False;
 
+    #ifdef ENA_SMP
+    // Only the main thread reads the moves from the serial port
+    if (engine->helper) { return False; }
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    // Nobody plays against the self-play games
+    if (engine->player) { return False; }
+    #endif
+
     if (Serial.available() == 5) {
         digits = True;
         for (i = 0; i < 5; i++) {
@@ -570,11 +551,11 @@ Bool check_serial()
         }
 
         if (digits) {
-            game.supplied = { index_t(movestr[0] + movestr[1] * 8), index_t(movestr[2] + movestr[3] * 8), 0L };
-            game.user_supplied = True;
+            engine->game.supplied = { index_t(movestr[0] + movestr[1] * 8), index_t(movestr[2] + movestr[3] * 8), 0L };
+            engine->game.user_supplied = True;
 
             printf(Debug1, "User move: ");
-            show_move(game.supplied);
+            show_move(engine->game.supplied);
             printnl(Debug1);
 
             moved = True;
@@ -593,22 +574,34 @@ Bool check_serial()
 // returns True if there is a move or False otherwise
 Bool check_book()
 {
+    // Each thread playing its own games keeps its own place in the book
+    #ifdef ENA_ENGINES
+    static thread_local index_t index = 0;
+    #else
     static index_t index = 0;
+    #endif
 
-    if (!game.options.openbook) { return False; }
+    if (!engine->game.options.openbook) { return False; }
 
-    if (game.turn != book_t::side) {
+    if (engine->game.turn != book_t::side) {
         return False;
     }
 
-    if ((index * 2) != game.move_num) {
+    #ifdef ENA_SELFPLAY
+    // Each self-play game starts at the beginning of the book
+    if (engine->player) {
+        index = engine->game.move_num / 2;
+    }
+    #endif
+
+    if ((index * 2) != engine->game.move_num) {
         return False;
     }
 
     if (index < index_t(ARRAYSZ(opening1))) {
-        game.supplied = { index_t(opening1[index].from), index_t(opening1[index].to), 0L };
-        game.book_supplied = True;
-        game.supply_valid = False;
+        engine->game.supplied = { index_t(opening1[index].from), index_t(opening1[index].to), 0L };
+        engine->game.book_supplied = True;
+        engine->game.supply_valid = False;
         index++;
         return True;
     }
@@ -627,7 +620,7 @@ Bool would_repeat(move_t const &move)
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
-    game_t::history_t m;
+    pmove_t m;
     index_t total, i;
     Bool result;
 
@@ -638,17 +631,17 @@ Bool would_repeat(move_t const &move)
 
     total = MAX_REPS * 2 - 1;
 
-    if (game.hist_count < total) {
+    if (engine->game.hist_count < total) {
         return False;
     }
 
     result = True;
 
-    m = { move.from, move.to };
+    m = pmove_t(move.from, move.to);
 
     for (i = 1; i < total; i += 2) {
-        if (game.history[i].to == m.from && game.history[i].from == m.to) {
-            m = game.history[i];
+        if (engine->game.history[i].to == m.from && engine->game.history[i].from == m.to) {
+            m = engine->game.history[i];
         }
         else {
             result = False;
@@ -679,10 +672,10 @@ Bool add_to_history(move_t const &move)
 
     result = would_repeat(move);
 
-    memmove(&game.history[1], &game.history[0], sizeof(game_t::history_t) * (ARRAYSZ(game.history) - 1));
-    game.history[0] = { move.from, move.to };
-    if (game.hist_count < index_t(ARRAYSZ(game.history))) {
-        game.hist_count++;
+    memmove(&engine->game.history[1], &engine->game.history[0], sizeof(pmove_t) * (ARRAYSZ(engine->game.history) - 1));
+    engine->game.history[0] = pmove_t(move.from, move.to);
+    if (engine->game.hist_count < index_t(ARRAYSZ(engine->game.history))) {
+        engine->game.hist_count++;
     }
 
     return result;
@@ -708,7 +701,7 @@ void show_side(Color const side)
 
 void show_check(Color const side, Bool const mate /* = False */)
 {
-    if (game.options.print_level >= Debug1) {
+    if (engine->game.options.print_level >= Debug1) {
         show_side(side);
 
         if (mate) {
@@ -727,16 +720,16 @@ void show_check(Color const side, Bool const mate /* = False */)
 
 void show_check_status() {
     // Announce if either King is in check
-    if (game.white_king_in_check) {
+    if (engine->game.white_king_in_check) {
         show_check(White);
     }
 
-    if (game.black_king_in_check) {
+    if (engine->game.black_king_in_check) {
         show_check(Black);
     }
 
     printnl(Debug1);
-    if (game.white_king_in_check || game.black_king_in_check) { 
+    if (engine->game.white_king_in_check || engine->game.black_king_in_check) { 
         printnl(Debug1);
     }
 
@@ -767,9 +760,9 @@ void show_piece(Piece const piece)
 // debug function to display all of the point_t's in the game.pieces[game.piece_count] list:
 void show_pieces()
 {
-    printf(Debug1, "game.pieces[%2d] = {\n", game.piece_count);
-    for (int i = 0; i < game.piece_count; i++) {
-        point_t const &loc = game.pieces[i];
+    printf(Debug1, "game.pieces[%2d] = {\n", engine->game.piece_count);
+    for (int i = 0; i < engine->game.piece_count; i++) {
+        point_t const &loc = engine->game.pieces[i];
         index_t const col = loc.x;
         index_t const row = loc.y;
 
@@ -777,7 +770,7 @@ void show_pieces()
             printf(Debug1, "    game.pieces[%2d] = Empty", i);
         }
         else {
-            Piece  const p = board.get(col + row * 8u);
+            Piece  const p = engine->board.get(col + row * 8u);
             printf(Debug1, "    game.pieces[%2d] = %2d, %2d (%2d): ", i, col, row, col + row * 8u);
             show_piece(p);
         }
@@ -794,10 +787,10 @@ void show_move(move_t const &move, Bool const align /* = False */)
 {
     index_t const    col = move.from % 8;
     index_t const    row = move.from / 8;
-    Piece   const      p = board.get(move.from);
+    Piece   const      p = engine->board.get(move.from);
     index_t const to_col = move.to % 8;
     index_t const to_row = move.to / 8;
-    Piece   const     op = board.get(move.to);
+    Piece   const     op = engine->board.get(move.to);
 
     show_piece(p);
 
@@ -856,6 +849,9 @@ void show_time(uint32_t ms)
 
 #ifdef ESP32
 int freeMemory() { return 0; }
+#elif defined(HOSTED_BUILD)
+// A desktop host doesn't share a few KB of RAM between the heap and the stack
+int freeMemory() { return INT_MAX; }
 #else
 int freeMemory() {
     #ifdef __arm__ 
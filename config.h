@@ -0,0 +1,48 @@
+/**
+ * config.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The search_config_t policy for the search features that are tested
+ * at every node. runtime_config_t reads them from game.options so they
+ * can be changed while running. fixed_config_t has them as constants
+ * so the compiler leaves the disabled ones out of the search.
+ *
+ */
+#ifndef CONFIG_INCL
+#define CONFIG_INCL
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the search features read from game.options at every node
+struct runtime_config_t {
+    static Bool    alpha_beta_pruning() { return engine->game.options.alpha_beta_pruning; }
+    static Bool    integrate()          { return engine->game.options.integrate; }
+    static Bool    random_ties()        { return engine->game.options.random_ties; }
+    static Bool    live_update()        { return engine->game.options.live_update; }
+    static index_t mistakes()           { return engine->game.options.mistakes; }
+    static index_t randskip()           { return engine->game.options.randskip; }
+
+};  // runtime_config_t
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the search features fixed when compiling. Edit these to pick the features that
+// the search is built with when ENA_FIXED_CONFIG is defined.
+struct fixed_config_t {
+    static Bool    constexpr alpha_beta_pruning() { return True; }
+    static Bool    constexpr integrate()          { return False; }
+    static Bool    constexpr random_ties()        { return False; }
+    static Bool    constexpr live_update()        { return False; }
+    static index_t constexpr mistakes()           { return 0; }
+    static index_t constexpr randskip()           { return 0; }
+
+};  // fixed_config_t
+
+
+#ifdef ENA_FIXED_CONFIG
+typedef fixed_config_t      search_config_t;
+#else
+typedef runtime_config_t    search_config_t;
+#endif
+
+#endif // CONFIG_INCL
@@ -0,0 +1,65 @@
+/**
+ * engine.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess engine context implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "engine.h"
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set up the board, the game and the move ordering tables for a new game
+void engine_t::init()
+{
+    #ifdef ENA_ENGINES
+    engine = this;
+    #endif
+
+    #ifdef ENA_SMP
+    helper = False;
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    player = False;
+    #endif
+
+    board.init();
+    game.init();
+    heuristics.clear();
+
+} // engine_t::init()
+
+
+#ifdef ENA_ENGINES
+////////////////////////////////////////////////////////////////////////////////////////
+// Seed the pseudo-random numbers used by the search
+void engine_t::seed(uint32_t const value)
+{
+    prng = value;
+
+} // engine_t::seed(uint32_t const value)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get a pseudo-random number from 0 to howbig - 1 using the engine's own state
+long engine_t::random(long const howbig)
+{
+    uint32_t bits;
+
+    if (howbig <= 0) {
+        return 0;
+    }
+
+    prng += 0x9E3779B9UL;
+    bits = prng;
+    bits = (bits ^ (bits >> 16)) * 0x85EBCA6BUL;
+    bits = (bits ^ (bits >> 13)) * 0xC2B2AE35UL;
+    bits ^= bits >> 16;
+
+    return long(bits % uint32_t(howbig));
+
+} // engine_t::random(long const howbig)
+#endif
@@ -0,0 +1,85 @@
+/**
+ * engine.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The engine_t context that owns the state of a game and its search:
+ * the board, the game with its options, the principal variation and
+ * the tables used to order the moves. The magic bitboard tables are
+ * shared by all of the engines, and so is the transposition table unless
+ * an engine is given one of its own.
+ *
+ */
+#ifndef ENGINE_INCL
+#define ENGINE_INCL
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the state of a game and its search
+class engine_t {
+    public:
+    board_t         board;
+    game_t          game;
+    pv_t            pv;
+    heuristics_t    heuristics;
+
+    #ifdef ENA_MOVE_LIST
+    move_stack_t    move_stack;
+    #endif
+
+    #ifdef ENA_SMP
+    // True when the engine searches for one of the Lazy SMP helper threads
+    Bool            helper;
+    #endif
+
+    #ifdef ENA_SELFPLAY
+    // True when the engine plays one of the self-play games on its own thread
+    Bool            player;
+    #endif
+
+    #ifdef ENA_ENGINES
+    // The state of the engine's own pseudo-random numbers so that the
+    // games played on the other threads don't change which ones it gets
+    uint32_t        prng;
+
+    // The transposition table the engine searches with
+    ttable_t *      table = &ttable;
+    #endif
+
+    // Set up the board, the game and the move ordering tables for a new game.
+    // With ENA_ENGINES this also makes it the engine the calling thread uses.
+    void init();
+
+    #ifdef ENA_ENGINES
+    // Seed the pseudo-random numbers used by the search
+    void seed(uint32_t const value);
+
+    // Get a pseudo-random number from 0 to howbig - 1
+    long random(long const howbig);
+    #else
+    void seed(uint32_t const value) { randomSeed(value); }
+    long random(long const howbig) { return ::random(howbig); }
+    #endif
+
+    // Get the transposition table the engine searches with
+    #ifdef ENA_ENGINES
+    ttable_t &tt() { return *table; }
+    #else
+    ttable_t &tt() { return ttable; }
+    #endif
+
+};  // engine_t
+
+// The engine that the sketch plays with
+extern engine_t default_engine;
+
+// All of the engine functions work on the engine that 'engine' points to.
+// With ENA_ENGINES each thread points it at its own engine_t so that more
+// than one search can run in the same process. Otherwise there is only the
+// default engine and its address is known when compiling.
+#ifdef ENA_ENGINES
+extern thread_local engine_t *engine;
+#else
+static engine_t * const engine = &default_engine;
+#endif
+
+#endif // ENGINE_INCL
@@ -10,9 +10,6 @@
 #include "MicroChess.h"
 #include "game.h"
 
-// The game options
-options_t game_t::options;
-
 game_t::game_t()
 {
     init();
@@ -34,12 +31,29 @@ void game_t::set_pieces_from_board(board_t &board)
         }
     }
 
+    set_map_from_pieces();
+
 } // game_t::set_pieces_from_board(board_t &board)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// Compare the pieces[] array to the board contents and return False
-// if there are differences or return True if they are the same.
+// Set the piece_map[] array based off of the pieces[] array
+void game_t::set_map_from_pieces()
+{
+    memset(piece_map, -1, sizeof(piece_map));
+
+    for (index_t piece_index = 0; piece_index < piece_count; piece_index++) {
+        if (isValidPos(pieces[piece_index].x, pieces[piece_index].y)) {
+            piece_map[pieces[piece_index].x + pieces[piece_index].y * 8u] = piece_index;
+        }
+    }
+
+} // game_t::set_map_from_pieces()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Compare the pieces[] and piece_map[] arrays to the board contents and return
+// False if there are differences or return True if they are the same.
 Bool game_t::compare_pieces_to_board(board_t &board) const
 {
     for (index_t index = 0; index < index_t(BOARD_SIZE); index++) {
@@ -57,10 +71,23 @@ Bool game_t::compare_pieces_to_board(board_t &board) const
             continue;
         }
 
-        if (-1 == piece_index) {
+        if (-1 == piece_index || piece_index >= index_t(piece_count)) {
             // ERROR - we should have found this spot
             return False;
         }
+
+        if (pieces[piece_index].x + pieces[piece_index].y * 8 != index) {
+            // ERROR - the piece list and the map disagree
+            return False;
+        }
+    }
+
+    // Make sure every piece in the list is in the map
+    for (index_t piece_index = 0; piece_index < piece_count; piece_index++) {
+        if (isValidPos(pieces[piece_index].x, pieces[piece_index].y) &&
+            piece_map[pieces[piece_index].x + pieces[piece_index].y * 8] != piece_index) {
+            return False;
+        }
     }
 
     return True;
@@ -69,33 +96,83 @@ Bool game_t::compare_pieces_to_board(board_t &board) const
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// Find the piece index for a given board index.
-// 
-// returns the index into the game.pieces[] array for the specified piece
-index_t game_t::find_piece(index_t const index) const
+// Add (sign = +1) or remove (sign = -1) the material, center and King proximity
+// terms for a piece at a board location to a set of evaluation totals. The
+// proximity is measured to where the opponent's King is now.
+static void piece_eval(game_t const &game, Piece const piece, index_t const index, int const sign, game_t::eval_t &totals)
 {
+    Piece   const ptype = getType(piece);
+    Color   const pside = getSide(piece);
+    index_t const col = index % 8;
+    index_t const row = index / 8;
+    index_t kloc, col_dist, row_dist;
+
+    if (Empty == ptype) { return; }
+
+    // Material Bonus
+    totals.material += sign * int32_t(pgm_read_dword(&game_t::material_bonus[ptype][pside]));
+
+    // Let's not encourage the King to wander to
+    // the center of the board mmkay?
+    if (King == ptype) { return; }
+
+    // Center Bonus
+    totals.center += sign * (
+        int32_t(pgm_read_dword(&game_t::center_bonus[col][ptype][pside])) +
+        int32_t(pgm_read_dword(&game_t::center_bonus[row][ptype][pside])));
+
+    // Proximity to opponent's King Bonus
+    kloc = (White == pside) ? game.bking : game.wking;
+    col_dist = (col > (kloc % 8)) ? (col - (kloc % 8)) : ((kloc % 8) - col);
+    row_dist = (row > (kloc / 8)) ? (row - (kloc / 8)) : ((kloc / 8) - row);
+    totals.proximity += sign * ((White == pside) ? +1 : -1) * (14 - (col_dist + row_dist));
+
+} // piece_eval(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Calculate the evaluation totals from scratch from the pieces[] array and the board
+void game_t::calc_eval(board_t const &board, eval_t &totals) const
+{
+    totals = { 0, 0, 0 };
+
     for (index_t piece_index = 0; piece_index < piece_count; piece_index++) {
-        if (!isValidPos(pieces[piece_index].x, pieces[piece_index].y)) {
-            continue;
-        }
-        else {
-            index_t const board_index = pieces[piece_index].x + pieces[piece_index].y * 8u;
-            if (board_index == index) {
-                return piece_index;
-            }
-        }
+        if (!isValidPos(pieces[piece_index].x, pieces[piece_index].y)) { continue; }
+
+        index_t const index = pieces[piece_index].x + pieces[piece_index].y * 8;
+        piece_eval(*this, board.get(index), index, +1, totals);
     }
 
-    return -1;
+} // game_t::calc_eval(board_t const &board, eval_t &totals)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Add (sign = +1) or remove (sign = -1) the evaluation terms for a piece at a board location
+void game_t::add_eval(Piece const piece, index_t const index, int const sign)
+{
+    piece_eval(*this, piece, index, sign, eval);
+
+} // game_t::add_eval(Piece const piece, index_t const index, int const sign)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Calculate the King proximity total again. Every piece on the other side is
+// closer to or further from a King when it moves so this is done from scratch.
+void game_t::set_proximity(board_t const &board)
+{
+    eval_t totals;
+
+    calc_eval(board, totals);
+    eval.proximity = totals.proximity;
 
-} // game_t::find_piece(int const index)
+} // game_t::set_proximity(board_t const &board)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Initialize for a new game
 void game_t::init()
 {
-    set_pieces_from_board(board);
+    set_pieces_from_board(engine->board);
 
     #ifdef ENA_MEM_STATS
     lowest_mem = 0xFFFF;
@@ -141,6 +218,10 @@ void game_t::init()
     supply_valid = False;
     supplied = { -1, -1, 0 };
 
+    hash = hash_board(turn);
+
+    calc_eval(engine->board, eval);
+
 } // game_t::init()
 
 
@@ -153,8 +234,8 @@ void game_t::sort_pieces(Color const side)
         auto compare = [](const void *a, const void *b) -> int {
             point_t const piece_a = *((point_t*) a);
             point_t const piece_b = *((point_t*) b);
-            Color   const side_a = getSide(board.get(piece_a.x + piece_a.y * 8));
-            Color   const side_b = getSide(board.get(piece_b.x + piece_b.y * 8));
+            Color   const side_a = getSide(engine->board.get(piece_a.x + piece_a.y * 8));
+            Color   const side_b = getSide(engine->board.get(piece_b.x + piece_b.y * 8));
             return (side_a == side_b) ? 0 : ((side_a < side_b) ? +1 : -1);
         };
 
@@ -165,14 +246,16 @@ void game_t::sort_pieces(Color const side)
         auto compare = [](const void *a, const void *b) -> int {
             point_t const piece_a = *((point_t*) a);
             point_t const piece_b = *((point_t*) b);
-            Color   const side_a = getSide(board.get(piece_a.x + piece_a.y * 8));
-            Color   const side_b = getSide(board.get(piece_b.x + piece_b.y * 8));
+            Color   const side_a = getSide(engine->board.get(piece_a.x + piece_a.y * 8));
+            Color   const side_b = getSide(engine->board.get(piece_b.x + piece_b.y * 8));
             return (side_a == side_b) ? 0 : ((side_a > side_b) ? +1 : -1);
         };
 
         qsort(pieces, piece_count, sizeof(point_t), compare);
     }
 
+    set_map_from_pieces();
+
 } // game_t::sort_pieces(Color const side)
 
 
@@ -186,7 +269,7 @@ void game_t::shuffle_pieces(index_t const shuffle_count)
     for (count = 0; (count + 1) < piece_count; count++) {
         index_t const index1 = pieces[count].x + pieces[count].y * 8u;
         index_t const index2 = pieces[count + 1].x + pieces[count + 1].y * 8u;
-        if (getSide(board.get(index1)) != getSide(board.get(index2))) {
+        if (getSide(engine->board.get(index1)) != getSide(engine->board.get(index2))) {
             break;
         }
     }
@@ -194,8 +277,8 @@ void game_t::shuffle_pieces(index_t const shuffle_count)
     // Shuffle the pieces
     if (count > 1) {
         for (index_t i = 0; i < shuffle_count; i++) {
-            index_t r1 = random(count);
-            index_t r2 = random(count);
+            index_t r1 = engine->random(count);
+            index_t r2 = engine->random(count);
             if (r1 == r2) { continue; }
             point_t const tmp = pieces[r1];
             pieces[r1] = pieces[r2];
@@ -203,6 +286,8 @@ void game_t::shuffle_pieces(index_t const shuffle_count)
         }
     }
 
+    set_map_from_pieces();
+
 } // game_t::shuffle(...)
 
 
@@ -226,68 +311,68 @@ static int constexpr QUEEN  = 1;
 long const game_t::center_bonus[ 8 ][ 7 ][ 2 ] PROGMEM = {
     //                      Black                   ,                      White 
     {
-        { 0 *  EMPTY * options.centerBonus * -1,    0 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 7 *   PAWN * options.centerBonus * -1,    0 *   PAWN * options.centerBonus * +1 },
-        { 0 * KNIGHT * options.centerBonus * -1,    0 * KNIGHT * options.centerBonus * +1 },
-        { 0 * BISHOP * options.centerBonus * -1,    0 * BISHOP * options.centerBonus * +1 },
-        { 0 *   ROOK * options.centerBonus * -1,    0 *   ROOK * options.centerBonus * +1 },
-        { 0 *  QUEEN * options.centerBonus * -1,    0 *  QUEEN * options.centerBonus * +1 },
+        { 0 *  EMPTY * -1,    0 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 7 *   PAWN * -1,    0 *   PAWN * +1 },
+        { 0 * KNIGHT * -1,    0 * KNIGHT * +1 },
+        { 0 * BISHOP * -1,    0 * BISHOP * +1 },
+        { 0 *   ROOK * -1,    0 *   ROOK * +1 },
+        { 0 *  QUEEN * -1,    0 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 1 *  EMPTY * options.centerBonus * -1,    1 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 6 *   PAWN * options.centerBonus * -1,    1 *   PAWN * options.centerBonus * +1 },
-        { 1 * KNIGHT * options.centerBonus * -1,    1 * KNIGHT * options.centerBonus * +1 },
-        { 1 * BISHOP * options.centerBonus * -1,    1 * BISHOP * options.centerBonus * +1 },
-        { 1 *   ROOK * options.centerBonus * -1,    1 *   ROOK * options.centerBonus * +1 },
-        { 1 *  QUEEN * options.centerBonus * -1,    1 *  QUEEN * options.centerBonus * +1 },
+        { 1 *  EMPTY * -1,    1 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 6 *   PAWN * -1,    1 *   PAWN * +1 },
+        { 1 * KNIGHT * -1,    1 * KNIGHT * +1 },
+        { 1 * BISHOP * -1,    1 * BISHOP * +1 },
+        { 1 *   ROOK * -1,    1 *   ROOK * +1 },
+        { 1 *  QUEEN * -1,    1 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 2 *  EMPTY * options.centerBonus * -1,    2 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 5 *   PAWN * options.centerBonus * -1,    2 *   PAWN * options.centerBonus * +1 },
-        { 2 * KNIGHT * options.centerBonus * -1,    2 * KNIGHT * options.centerBonus * +1 },
-        { 2 * BISHOP * options.centerBonus * -1,    2 * BISHOP * options.centerBonus * +1 },
-        { 2 *   ROOK * options.centerBonus * -1,    2 *   ROOK * options.centerBonus * +1 },
-        { 2 *  QUEEN * options.centerBonus * -1,    2 *  QUEEN * options.centerBonus * +1 },
+        { 2 *  EMPTY * -1,    2 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 5 *   PAWN * -1,    2 *   PAWN * +1 },
+        { 2 * KNIGHT * -1,    2 * KNIGHT * +1 },
+        { 2 * BISHOP * -1,    2 * BISHOP * +1 },
+        { 2 *   ROOK * -1,    2 *   ROOK * +1 },
+        { 2 *  QUEEN * -1,    2 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 3 *  EMPTY * options.centerBonus * -1,    3 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 4 *   PAWN * options.centerBonus * -1,    3 *   PAWN * options.centerBonus * +1 },
-        { 3 * KNIGHT * options.centerBonus * -1,    3 * KNIGHT * options.centerBonus * +1 },
-        { 3 * BISHOP * options.centerBonus * -1,    3 * BISHOP * options.centerBonus * +1 },
-        { 3 *   ROOK * options.centerBonus * -1,    3 *   ROOK * options.centerBonus * +1 },
-        { 3 *  QUEEN * options.centerBonus * -1,    3 *  QUEEN * options.centerBonus * +1 },
+        { 3 *  EMPTY * -1,    3 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 4 *   PAWN * -1,    3 *   PAWN * +1 },
+        { 3 * KNIGHT * -1,    3 * KNIGHT * +1 },
+        { 3 * BISHOP * -1,    3 * BISHOP * +1 },
+        { 3 *   ROOK * -1,    3 *   ROOK * +1 },
+        { 3 *  QUEEN * -1,    3 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 3 *  EMPTY * options.centerBonus * -1,    3 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 3 *   PAWN * options.centerBonus * -1,    4 *   PAWN * options.centerBonus * +1 },
-        { 3 * KNIGHT * options.centerBonus * -1,    3 * KNIGHT * options.centerBonus * +1 },
-        { 3 * BISHOP * options.centerBonus * -1,    3 * BISHOP * options.centerBonus * +1 },
-        { 3 *   ROOK * options.centerBonus * -1,    3 *   ROOK * options.centerBonus * +1 },
-        { 3 *  QUEEN * options.centerBonus * -1,    3 *  QUEEN * options.centerBonus * +1 },
+        { 3 *  EMPTY * -1,    3 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 3 *   PAWN * -1,    4 *   PAWN * +1 },
+        { 3 * KNIGHT * -1,    3 * KNIGHT * +1 },
+        { 3 * BISHOP * -1,    3 * BISHOP * +1 },
+        { 3 *   ROOK * -1,    3 *   ROOK * +1 },
+        { 3 *  QUEEN * -1,    3 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 2 *  EMPTY * options.centerBonus * -1,    2 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 2 *   PAWN * options.centerBonus * -1,    5 *   PAWN * options.centerBonus * +1 },
-        { 2 * KNIGHT * options.centerBonus * -1,    2 * KNIGHT * options.centerBonus * +1 },
-        { 2 * BISHOP * options.centerBonus * -1,    2 * BISHOP * options.centerBonus * +1 },
-        { 2 *   ROOK * options.centerBonus * -1,    2 *   ROOK * options.centerBonus * +1 },
-        { 2 *  QUEEN * options.centerBonus * -1,    2 *  QUEEN * options.centerBonus * +1 },
+        { 2 *  EMPTY * -1,    2 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 2 *   PAWN * -1,    5 *   PAWN * +1 },
+        { 2 * KNIGHT * -1,    2 * KNIGHT * +1 },
+        { 2 * BISHOP * -1,    2 * BISHOP * +1 },
+        { 2 *   ROOK * -1,    2 *   ROOK * +1 },
+        { 2 *  QUEEN * -1,    2 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 1 *  EMPTY * options.centerBonus * -1,    1 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 1 *   PAWN * options.centerBonus * -1,    6 *   PAWN * options.centerBonus * +1 },
-        { 1 * KNIGHT * options.centerBonus * -1,    1 * KNIGHT * options.centerBonus * +1 },
-        { 1 * BISHOP * options.centerBonus * -1,    1 * BISHOP * options.centerBonus * +1 },
-        { 1 *   ROOK * options.centerBonus * -1,    1 *   ROOK * options.centerBonus * +1 },
-        { 1 *  QUEEN * options.centerBonus * -1,    1 *  QUEEN * options.centerBonus * +1 },
+        { 1 *  EMPTY * -1,    1 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 1 *   PAWN * -1,    6 *   PAWN * +1 },
+        { 1 * KNIGHT * -1,    1 * KNIGHT * +1 },
+        { 1 * BISHOP * -1,    1 * BISHOP * +1 },
+        { 1 *   ROOK * -1,    1 *   ROOK * +1 },
+        { 1 *  QUEEN * -1,    1 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }, {
-        { 0 *  EMPTY * options.centerBonus * -1,    0 *  EMPTY * options.centerBonus * +1 },       // col/row offset 0; 3 from center
-        { 0 *   PAWN * options.centerBonus * -1,    7 *   PAWN * options.centerBonus * +1 },
-        { 0 * KNIGHT * options.centerBonus * -1,    0 * KNIGHT * options.centerBonus * +1 },
-        { 0 * BISHOP * options.centerBonus * -1,    0 * BISHOP * options.centerBonus * +1 },
-        { 0 *   ROOK * options.centerBonus * -1,    0 *   ROOK * options.centerBonus * +1 },
-        { 0 *  QUEEN * options.centerBonus * -1,    0 *  QUEEN * options.centerBonus * +1 },
+        { 0 *  EMPTY * -1,    0 *  EMPTY * +1 },       // col/row offset 0; 3 from center
+        { 0 *   PAWN * -1,    7 *   PAWN * +1 },
+        { 0 * KNIGHT * -1,    0 * KNIGHT * +1 },
+        { 0 * BISHOP * -1,    0 * BISHOP * +1 },
+        { 0 *   ROOK * -1,    0 *   ROOK * +1 },
+        { 0 *  QUEEN * -1,    0 *  QUEEN * +1 },
         {                             MAX_VALUE,                                MIN_VALUE },
     }
 };
@@ -15,7 +15,6 @@
 #include "stats.h"
 #include "options.h"
 
-extern board_t board;
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // board spot by column and row
@@ -36,12 +35,16 @@ class game_t
 {
     public:
     // The game options
-    static options_t options;
+    options_t   options;
 
     // The locations of the pieces on the board
     point_t     pieces[MAX_PIECES];
     uint8_t     piece_count;
 
+    // The pieces[] index of the piece at each board location (-1 if none).
+    // This is kept in step with pieces[] as moves are made and unmade.
+    index_t     piece_map[BOARD_SIZE];
+
     uint8_t
                           wking : 6,    // the location of the white king
         last_was_pawn_promotion : 1,    // True when last move promoted a Pawn to a Queen
@@ -63,11 +66,7 @@ class game_t
                            turn : 1;    // Whose turn it is: 0 := Black, 1 := White
 
     // The last 'MAX_REPS * 2 - 1' moves are kept to recognize 'MAX_REPS' move repetition
-    struct history_t {
-        index_t from : 6, 
-                  to : 6;
-
-    } history[MAX_REPS * 2 - 1];
+    pmove_t     history[MAX_REPS * 2 - 1];
 
     uint8_t     hist_count;
 
@@ -92,6 +91,53 @@ class game_t
     // Increasing move number
     uint8_t     move_num;
 
+    // The Zobrist hash of the board, castling and en-passant state, and the side
+    // to move. This is updated incrementally as moves are made and unmade.
+    uint64_t    hash;
+
+    // The running totals of the evaluation terms that only change with the pieces that
+    // move. make_move(...) applies the changes for each move and evaluate(...) only has
+    // to add the mobility bonus.
+    struct eval_t {
+        long    material;   // material bonus, before options.materialBonus
+        long    center;     // center bonus, before options.centerBonus
+        long    proximity;  // proximity to the opponent's King, before options.kingBonus
+
+    } eval;
+
+    // The game state that make(...) changes for a move, saved so that unmake(...) can
+    // put it back. There is one record for each ply, and game.ply is 3 bits so there
+    // are at most 8 plies.
+    struct undo_t {
+        uint64_t    hash;               // the hash before the move
+        eval_t      eval;               // the evaluation totals before the move
+        move_t      last_move;          // the last move before the move
+        index_t     captured;           // the board location of the piece taken or -1 if none
+        index_t     taken_index;        // the pieces[] index of the piece taken
+        index_t     castly_rook;        // the pieces[] index of the rook moved when castling or -1
+
+        uint8_t
+                                 op : 6,    // the Piece at the destination before the move
+            last_was_pawn_promotion : 1,
+                last_was_en_passant : 1,
+
+                     captured_piece : 6,    // the Piece taken
+                    last_was_castle : 1,
+                       supply_valid : 1,
+
+                              wking : 6,    // the locations of the kings
+                      book_supplied : 1,
+                      user_supplied : 1,
+
+                              bking : 6,
+                white_king_in_check : 1,
+                black_king_in_check : 1,
+
+                  white_taken_count : 5,    // the number of pieces taken by each side
+                  black_taken_count : 5;
+
+    } undo[8];
+
     // The alpha and beta boundaries of our search envelope
     long        alpha;
     long        beta;
@@ -134,8 +180,23 @@ public:
     // Check the integrity of the game.pieces[] array compared to the board contents
     Bool compare_pieces_to_board(board_t &board) const;
 
+    // Set the piece_map[] array based off of the pieces[] array
+    void set_map_from_pieces();
+
+    // Calculate the evaluation totals from the pieces[] array and the board contents
+    void calc_eval(board_t const &board, eval_t &totals) const;
+
+    // Add (sign = +1) or remove (sign = -1) the evaluation terms for a piece at a board location
+    void add_eval(Piece const piece, index_t const index, int const sign);
+
+    // Calculate the King proximity total again after one of the Kings moves
+    void set_proximity(board_t const &board);
+
     // Find the game.pieces[] array index for the given board location
-    index_t find_piece(index_t const index) const;
+    index_t find_piece(index_t const index) const
+    {
+        return piece_map[index];
+    }
 
 };  // game_t
 
@@ -0,0 +1,124 @@
+/**
+ * heuristics.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess killer move and history table implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "heuristics.h"
+
+heuristics_t::heuristics_t()
+{
+    clear();
+
+} // heuristics_t::heuristics_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Empty the tables
+void heuristics_t::clear()
+{
+    memset(killers, 0, sizeof(killers));
+
+    #ifdef ENA_HISTORY
+    memset(history, 0, sizeof(history));
+    #endif
+
+} // heuristics_t::clear()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get ready for the next turn. The positions at ply 1 of the last search are
+// at ply 0 now so the killer moves move up a ply. The history counts are
+// halved so the moves that caused cutoffs lately count the most.
+void heuristics_t::age()
+{
+    memmove(&killers[0], &killers[1], sizeof(killers) - sizeof(killers[0]));
+    memset(&killers[ARRAYSZ(killers) - 1], 0, sizeof(killers[0]));
+
+    #ifdef ENA_HISTORY
+    halve();
+    #endif
+
+} // heuristics_t::age()
+
+
+#ifdef ENA_HISTORY
+////////////////////////////////////////////////////////////////////////////////////////
+// Halve all of the history counts
+void heuristics_t::halve()
+{
+    uint16_t *counts = &history[0][0][0];
+
+    for (uint16_t index = 0; index < sizeof(history) / sizeof(history[0][0][0]); index++) {
+        counts[index] /= 2;
+    }
+
+} // heuristics_t::halve()
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Remember a quiet move that caused a cutoff. The deeper the search below
+// the move was, the more its history count goes up.
+void heuristics_t::update(Color const side, index_t const ply, index_t const depth, move_t const &move)
+{
+    pmove_t &first = killers[ply][0];
+
+    if (!first.matches(move)) {
+        killers[ply][1] = first;
+        first = pmove_t(move.from, move.to);
+    }
+
+    #ifdef ENA_HISTORY
+    uint16_t &count = history[side][move.from][move.to];
+    count += (depth > 1) ? depth * depth : 1;
+
+    // Keep the counts below the score used for the killer moves
+    if (count > ORDER_HISTORY) {
+        halve();
+    }
+    #else
+    (void) side;
+    (void) depth;
+    #endif
+
+} // heuristics_t::update(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the killer slot a move is in at a ply.
+//
+// returns 0 or 1 for the slot, or -1 if the move isn't a killer move
+index_t heuristics_t::killer(index_t const ply, move_t const &move) const
+{
+    for (index_t slot = 0; slot < 2; slot++) {
+        pmove_t const &entry = killers[ply][slot];
+        if ((entry.from != entry.to) && entry.matches(move)) {
+            return slot;
+        }
+    }
+
+    return -1;
+
+} // heuristics_t::killer(index_t const ply, move_t const &move)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the history count for a move
+//
+// returns the count, or 0 if the history table isn't enabled
+uint16_t heuristics_t::score(Color const side, move_t const &move) const
+{
+    #ifdef ENA_HISTORY
+    return min(history[side][move.from][move.to], uint16_t(ORDER_HISTORY));
+    #else
+    (void) side;
+    (void) move;
+    return 0;
+    #endif
+
+} // heuristics_t::score(Color const side, move_t const &move)
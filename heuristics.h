@@ -0,0 +1,51 @@
+/**
+ * heuristics.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The heuristics_t killer move and history tables used to order the
+ * quiet moves that caused alpha-beta cutoffs before.
+ *
+ */
+#ifndef HEURISTICS_INCL
+#define HEURISTICS_INCL
+
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the killer move and history tables
+class heuristics_t {
+    private:
+    // The last two quiet moves that caused a cutoff at each ply (from == to if none).
+    // game.ply is 3 bits so there are at most 8 plies.
+    pmove_t     killers[8][2];
+
+    #ifdef ENA_HISTORY
+    // How often each quiet move caused a cutoff for each side, weighted by depth
+    uint16_t    history[2][64][64];
+
+    // Halve all of the history counts
+    void halve();
+    #endif
+
+    public:
+    heuristics_t();
+
+    // Empty the tables
+    void clear();
+
+    // Move the killer moves up a ply and halve the history counts for the next turn
+    void age();
+
+    // Remember a quiet move that caused a cutoff
+    void update(Color const side, index_t const ply, index_t const depth, move_t const &move);
+
+    // Get the killer slot a move is in at a ply or -1 if it isn't a killer move
+    index_t killer(index_t const ply, move_t const &move) const;
+
+    // Get the history count for a move, up to ORDER_HISTORY
+    uint16_t score(Color const side, move_t const &move) const;
+
+};  // heuristics_t
+
+#endif // HEURISTICS_INCL
@@ -57,7 +57,7 @@ void set_led_strip(index_t const flash /* = -1 */)
     for (vars.y = 0; vars.y < 8; vars.y++) {
         for (vars.x = 0; vars.x < 8; vars.x++) {
             vars.board_index = vars.x + vars.y * 8u;
-            vars.piece = board.get(vars.board_index);
+            vars.piece = engine->board.get(vars.board_index);
             vars.type = getType(vars.piece);
             vars.side = getSide(vars.piece);
             vars.ex = 7 - vars.x;
@@ -0,0 +1,211 @@
+/**
+ * magic.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess sliding piece attack table implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "magic.h"
+
+#ifdef ENA_MAGIC
+
+// PEXT is only available on x86 CPUs with BMI2, so we compile it for BMI2
+// here and check that the CPU we are running on has it before using it
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ENA_PEXT
+#include <immintrin.h>
+#endif
+
+// The directions the Rook and the Bishop slide in
+static int8_t constexpr rook_dirs[4][2]   = { {  0,  1 }, {  0, -1 }, { -1,  0 }, {  1,  0 } };
+static int8_t constexpr bishop_dirs[4][2] = { { -1, -1 }, { -1,  1 }, {  1, -1 }, {  1,  1 } };
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Gather the bits of a value selected by a mask (PEXT)
+#ifdef ENA_PEXT
+__attribute__((target("bmi2")))
+uint64_t pext(uint64_t const value, uint64_t const mask)
+{
+    return _pext_u64(value, mask);
+
+} // pext(uint64_t const value, uint64_t const mask)
+#else
+uint64_t pext(uint64_t const value, uint64_t const mask)
+{
+    uint64_t result = 0;
+    uint64_t bit = 1;
+
+    for (uint64_t m = mask; 0 != m; m &= m - 1, bit <<= 1) {
+        if (value & m & -m) { result |= bit; }
+    }
+
+    return result;
+
+} // pext(uint64_t const value, uint64_t const mask)
+#endif
+
+
+// Walk the rays out from a spot and get the spots a sliding piece attacks.
+// Each ray stops at the first piece in the way, which is attacked.
+static uint64_t slide(index_t const spot, int8_t const (* const dirs)[2], uint64_t const occupied)
+{
+    uint64_t attacks = 0;
+    int x, y;
+
+    for (index_t i = 0; i < 4; i++) {
+        x = spot % 8 + dirs[i][0];
+        y = spot / 8 + dirs[i][1];
+
+        while (x >= 0 && x <= 7 && y >= 0 && y <= 7) {
+            attacks |= 1ULL << (x + y * 8);
+            if (occupied & (1ULL << (x + y * 8))) { break; }
+            x += dirs[i][0];
+            y += dirs[i][1];
+        }
+    }
+
+    return attacks;
+
+} // slide(index_t const spot, int8_t const (* const dirs)[2], uint64_t const occupied)
+
+
+// Get the spots along the rays out from a spot that can block a sliding piece.
+// The last spot on each ray never blocks anything beyond it so it is left out.
+static uint64_t blockers(index_t const spot, int8_t const (* const dirs)[2])
+{
+    uint64_t mask = 0;
+    int x, y;
+
+    for (index_t i = 0; i < 4; i++) {
+        x = spot % 8 + dirs[i][0];
+        y = spot / 8 + dirs[i][1];
+
+        while (x + dirs[i][0] >= 0 && x + dirs[i][0] <= 7 && y + dirs[i][1] >= 0 && y + dirs[i][1] <= 7) {
+            mask |= 1ULL << (x + y * 8);
+            x += dirs[i][0];
+            y += dirs[i][1];
+        }
+    }
+
+    return mask;
+
+} // blockers(index_t const spot, int8_t const (* const dirs)[2])
+
+
+// A fixed pseudo random number generator (xorshift64*) so that the
+// same magic multipliers are found every time the tables are built
+static uint64_t magic_random(uint64_t &state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+
+    return state * 0x2545F4914F6CDD1DULL;
+
+} // magic_random(uint64_t &state)
+
+
+magic_t::magic_t()
+{
+    memset(rooks, 0, sizeof(rooks));
+    memset(bishops, 0, sizeof(bishops));
+    use_pext = False;
+
+} // magic_t::magic_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Build the tables. PEXT is used when the CPU has BMI2, otherwise we search
+// for a magic multiplier for each spot that hashes every set of blockers
+// into an index without mixing up two sets that attack different spots.
+void magic_t::init()
+{
+    uint64_t *next;
+
+    #ifdef ENA_PEXT
+    use_pext = __builtin_cpu_supports("bmi2") ? True : False;
+    #else
+    use_pext = False;
+    #endif
+
+    next = init_entries(rooks, rook_dirs, table);
+    next = init_entries(bishops, bishop_dirs, next);
+
+} // magic_t::init()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Build the lookups for each spot of one kind of sliding piece and
+// return the first unused attack set in the table after them
+uint64_t *magic_t::init_entries(entry_t * const entries, int8_t const (* const dirs)[2], uint64_t *next)
+{
+    // Each set of blockers for a spot and the spots attacked with them.
+    // The age each index was last filled during the current magic search.
+    static uint64_t occupied[4096];
+    static uint64_t attacks[4096];
+    static uint32_t epochs[4096];
+    uint32_t epoch = 0;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t subset, index;
+    uint16_t count, i;
+    index_t spot;
+    Bool found;
+
+    memset(epochs, 0, sizeof(epochs));
+
+    for (spot = 0; spot < 64; spot++) {
+        entry_t &entry = entries[spot];
+
+        entry.mask    = blockers(spot, dirs);
+        entry.shift   = 64 - __builtin_popcountll(entry.mask);
+        entry.attacks = next;
+        next += 1ULL << (64 - entry.shift);
+
+        // Walk every subset of the blockers
+        count = 0;
+        subset = 0;
+        do {
+            occupied[count] = subset;
+            attacks[count] = slide(spot, dirs, subset);
+            count++;
+            subset = (subset - entry.mask) & entry.mask;
+        } while (0 != subset);
+
+        if (use_pext) {
+            entry.magic = 0;
+            for (i = 0; i < count; i++) {
+                entry.attacks[pext(occupied[i], entry.mask)] = attacks[i];
+            }
+            continue;
+        }
+
+        // Try sparse random multipliers until one works
+        do {
+            do {
+                entry.magic = magic_random(state) & magic_random(state) & magic_random(state);
+            } while (__builtin_popcountll((entry.mask * entry.magic) >> 56) < 6);
+
+            epoch++;
+            found = True;
+            for (i = 0; found && i < count; i++) {
+                index = (occupied[i] * entry.magic) >> entry.shift;
+                if (epochs[index] < epoch) {
+                    epochs[index] = epoch;
+                    entry.attacks[index] = attacks[i];
+                }
+                else if (entry.attacks[index] != attacks[i]) {
+                    found = False;
+                }
+            }
+        } while (!found);
+    }
+
+    return next;
+
+} // magic_t::init_entries(entry_t * const entries, int8_t const (* const dirs)[2], uint64_t *next)
+
+#endif // ENA_MAGIC
@@ -0,0 +1,91 @@
+/**
+ * magic.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The magic_t sliding piece attack tables. The spots a Rook or Bishop
+ * attacks from a spot are looked up using the pieces that could block
+ * it, hashed with a magic multiplier or gathered with the BMI2 PEXT
+ * instruction when the CPU has it.
+ *
+ */
+#ifndef MAGIC_INCL
+#define MAGIC_INCL
+
+#include <stdint.h>
+
+#ifdef ENA_MAGIC
+
+// The number of attack sets for all 64 spots of each sliding piece
+enum : uint32_t {
+    ROOK_ATTACKS   = 102400,
+    BISHOP_ATTACKS = 5248
+};
+
+// Gather the bits of a value selected by a mask (PEXT)
+extern uint64_t pext(uint64_t const value, uint64_t const mask);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the sliding piece attack tables
+class magic_t {
+    private:
+    // The lookup for one spot
+    struct entry_t {
+        uint64_t    mask;       // the spots that can block the piece, not counting the edges
+        uint64_t    magic;      // the multiplier that hashes the blockers into an index
+        uint64_t   *attacks;    // the spots attacked for each set of blockers
+        uint8_t     shift;      // 64 minus the number of bits in the mask
+    };
+
+    entry_t     rooks[64];
+    entry_t     bishops[64];
+    uint64_t    table[ROOK_ATTACKS + BISHOP_ATTACKS];
+    Bool        use_pext;
+
+    uint64_t lookup(entry_t const &entry, uint64_t const occupied) const
+    {
+        if (use_pext) {
+            return entry.attacks[pext(occupied, entry.mask)];
+        }
+
+        return entry.attacks[((occupied & entry.mask) * entry.magic) >> entry.shift];
+    }
+
+    // Build the lookups for each spot of one kind of sliding piece
+    uint64_t *init_entries(entry_t * const entries, int8_t const (* const dirs)[2], uint64_t *next);
+
+    public:
+    magic_t();
+
+    // Build the tables. This must be called once before any lookups.
+    void init();
+
+    // True if the lookups use PEXT instead of the magic multipliers
+    Bool pext_enabled() const
+    {
+        return use_pext;
+    }
+
+    // Get the spots a piece attacks from a spot given all of the pieces on the board
+    uint64_t rook(index_t const spot, uint64_t const occupied) const
+    {
+        return lookup(rooks[spot], occupied);
+    }
+
+    uint64_t bishop(index_t const spot, uint64_t const occupied) const
+    {
+        return lookup(bishops[spot], occupied);
+    }
+
+    uint64_t queen(index_t const spot, uint64_t const occupied) const
+    {
+        return rook(spot, occupied) | bishop(spot, occupied);
+    }
+
+};  // magic_t
+
+extern magic_t magic;
+
+#endif // ENA_MAGIC
+
+#endif // MAGIC_INCL
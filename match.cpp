@@ -0,0 +1,152 @@
+/**
+ * match.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess A/B match implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "match.h"
+
+#ifdef ENA_MATCH
+
+#include <math.h>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the expected score for the side that is the given number of Elo stronger
+static double elo_score(double const elo)
+{
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+
+} // elo_score(double const elo)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Start a match between options.sides[White] (A) and options.sides[Black] (B)
+void match_t::init(options_t const &options)
+{
+    a = options.sides[White];
+    b = options.sides[Black];
+    wins = 0;
+    draws = 0;
+    losses = 0;
+    elo = options.sprt_elo;
+
+} // match_t::init(options_t const &options)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set up the options for one of the games of the match. A plays White in
+// the even games and Black in the odd ones.
+void match_t::setup_game(options_t &options, uint32_t const game) const
+{
+    Bool const a_white = (0 == (game & 1));
+
+    options.sides[White] = a_white ? a : b;
+    options.sides[Black] = a_white ? b : a;
+    options.per_side = True;
+
+} // match_t::setup_game(options_t &options, uint32_t const game)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Count how one of the games of the match ended
+void match_t::add(state_t const state, uint32_t const game)
+{
+    Bool const a_white = (0 == (game & 1));
+
+    switch (state) {
+        default:
+        case PLAYING:
+        case STALEMATE:
+        case MOVE_LIMIT:
+            draws++;
+            break;
+
+        case WHITE_CHECKMATE:
+        case BLACK_3_MOVE_REP:
+            if (a_white) { wins++; } else { losses++; }
+            break;
+
+        case BLACK_CHECKMATE:
+        case WHITE_3_MOVE_REP:
+            if (a_white) { losses++; } else { wins++; }
+            break;
+    }
+
+} // match_t::add(state_t const state, uint32_t const game)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the log-likelihood ratio of A being sprt_elo Elo stronger than B instead of
+// sprt_elo Elo weaker. This uses the normal approximation of the game results: the
+// mean and variance of A's score per game are measured from the games so far.
+//
+// Half a win and half a loss are added to the games so that the variance isn't 0
+// when every game has ended the same way, or a match that A or B wins every game
+// of would never be decided.
+double match_t::llr() const
+{
+    if (0 == games()) {
+        return 0.0;
+    }
+
+    double const count = games() + 1.0;
+    double const w = (wins + 0.5) / count;
+    double const d = draws / count;
+    double const score = w + d / 2.0;
+    double const variance = (w + d / 4.0 - score * score) / count;
+
+    double const s0 = elo_score(-double(elo));
+    double const s1 = elo_score(+double(elo));
+
+    return (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+
+} // match_t::llr()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// returns 1 if A is stronger, -1 if A is weaker, or 0 if it isn't known yet
+int match_t::result() const
+{
+    double const ratio = llr();
+
+    if (ratio >= log((1.0 - beta) / alpha)) {
+        return 1;
+    }
+
+    if (ratio <= log(beta / (1.0 - alpha))) {
+        return -1;
+    }
+
+    return 0;
+
+} // match_t::result()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Show the games won, drawn and lost by A and what the test says so far
+void match_t::show() const
+{
+    char str[16] = "";
+
+    printf(Debug1, "   Match A vs B: +%ld =%ld -%ld  ", wins, draws, losses);
+
+    ftostr(llr(), 2, str);
+    printf(Debug1, "LLR: %s ", str);
+    ftostr(log(beta / (1.0 - alpha)), 2, str);
+    printf(Debug1, "(%s, ", str);
+    ftostr(log((1.0 - beta) / alpha), 2, str);
+    printf(Debug1, "%s)  ", str);
+
+    switch (result()) {
+        case  1:    printf(Debug1, "A is stronger (%d Elo test)\n\n", elo);  break;
+        case -1:    printf(Debug1, "A is weaker (%d Elo test)\n\n", elo);    break;
+        default:    printf(Debug1, "undecided\n\n");                        break;
+    }
+
+} // match_t::show()
+
+#endif // ENA_MATCH
@@ -0,0 +1,69 @@
+/**
+ * match.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The match_t structure plays the options for White (A) against the
+ * options for Black (B). A plays White in the even games and Black in the
+ * odd ones. After each game a sequential probability ratio test (SPRT)
+ * says whether A has been shown to be stronger or weaker than B by
+ * game.options.sprt_elo Elo, so the match can stop as soon as it is.
+ *
+ */
+#ifndef MATCH_INCL
+#define MATCH_INCL
+
+#ifdef ENA_MATCH
+
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// a match between two sets of options
+struct match_t {
+    private:
+    // The options being tested against each other
+    side_options_t  a;
+    side_options_t  b;
+
+    // The games won, drawn and lost by A
+    uint32_t        wins;
+    uint32_t        draws;
+    uint32_t        losses;
+
+    // The Elo difference the test decides between
+    index_t         elo;
+
+    public:
+
+    // The chances of deciding that A is stronger when it isn't, and weaker when it isn't
+    static double constexpr alpha = 0.05;
+    static double constexpr beta  = 0.05;
+
+    // Start a match between options.sides[White] and options.sides[Black]
+    void init(options_t const &options);
+
+    // Set up the options for one of the games of the match
+    void setup_game(options_t &options, uint32_t const game) const;
+
+    // Count how one of the games of the match ended
+    void add(state_t const state, uint32_t const game);
+
+    // Get the number of games played so far
+    uint32_t games() const { return wins + draws + losses; }
+
+    // Get the log-likelihood ratio of A being sprt_elo stronger instead of sprt_elo weaker
+    double llr() const;
+
+    // returns 1 if A is stronger, -1 if A is weaker, or 0 if it isn't known yet
+    int result() const;
+
+    // Show the games won, drawn and lost by A and what the test says so far
+    void show() const;
+
+};  // match_t
+
+extern match_t match;
+
+#endif // ENA_MATCH
+
+#endif // MATCH_INCL
@@ -21,4 +21,24 @@ move_t::move_t(index_t f, index_t t, long v) :
     value(v)
 {
 
-}
\ No newline at end of file
+}
+
+
+pmove_t::pmove_t() {
+
+}
+
+
+pmove_t::pmove_t(index_t f, index_t t, uint8_t fl) :
+    from(f),
+    to(t),
+    flags(fl)
+{
+
+}
+
+
+Bool pmove_t::matches(move_t const &move) const
+{
+    return (from == move.from) && (to == move.to);
+}
@@ -24,4 +24,34 @@ class move_t
 
 };  // move_t
 
+
+// The flags kept with a packed move
+enum : uint8_t {
+    MOVE_CAPTURE    = 0x1,      // the move takes a piece
+    MOVE_PROMOTION  = 0x2,      // the move promotes a Pawn
+    MOVE_EN_PASSANT = 0x4,      // the move takes a Pawn en-passant
+    MOVE_CASTLE     = 0x8,      // the move castles the King
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+// a move packed into 16 bits without a value. This is what the move history, opening
+// book, killer moves and move stack keep, and any score is kept next to it.
+class pmove_t
+{
+    public:
+    uint16_t from : 6,      // the index into the board the move starts at
+               to : 6,      // the index into the board the move finishes at
+            flags : 4;      // the MOVE_XXX flags, or 0 when they aren't known
+
+    pmove_t();
+
+    pmove_t(index_t f, index_t t, uint8_t fl = 0);
+
+    // See if this is the same move as a move_t
+    Bool matches(move_t const &move) const;
+
+};  // pmove_t
+
+static_assert(sizeof(pmove_t) == 2, "pmove_t must be 16 bits");
+
 #endif // MOVE_INCL
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * movestack.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess move stack implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "movestack.h"
+
+#ifdef ENA_MOVE_LIST
+
+move_stack_t::move_stack_t()
+{
+    memset(ends, 0, sizeof(ends));
+    memset(picks, 0, sizeof(picks));
+    spills = 0;
+
+} // move_stack_t::move_stack_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the first entry of a ply's list
+uint16_t move_stack_t::first(index_t const ply) const
+{
+    return (0 == ply) ? 0 : ends[ply - 1];
+
+} // move_stack_t::first(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Start an empty list for a ply after the list for the ply before it
+void move_stack_t::begin(index_t const ply)
+{
+    ends[ply] = first(ply);
+    picks[ply] = first(ply);
+    spills &= ~(1 << ply);
+
+} // move_stack_t::begin(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Add a move to the end of a ply's list. When the stack is full the move with the
+// lowest score in the list makes room for it if the new move scores higher, so the
+// moves that are left off are always the ones that would have been searched last.
+void move_stack_t::add(index_t const ply, index_t const from, index_t const to, uint8_t const flags, int16_t const score)
+{
+    uint16_t low, i;
+
+    if (ends[ply] >= MOVE_STACK) {
+        spills |= 1 << ply;
+
+        low = first(ply);
+        if (low >= ends[ply]) {
+            return;
+        }
+
+        for (i = low + 1; i < ends[ply]; i++) {
+            if (moves[i].score <= moves[low].score) {
+                low = i;
+            }
+        }
+
+        if (score <= moves[low].score) {
+            return;
+        }
+
+        memmove(&moves[low], &moves[low + 1], (ends[ply] - low - 1) * sizeof(stack_move_t));
+        ends[ply]--;
+    }
+
+    moves[ends[ply]++] = { pmove_t(from, to, flags), score };
+
+} // move_stack_t::add(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Take the move with the highest score that hasn't been picked yet from a ply's list.
+// The moves in between are shifted down one entry instead of being swapped with it
+// so that the moves with the same score stay in the order they were added.
+//
+// returns the move or nullptr when all of the moves have been picked
+stack_move_t const *move_stack_t::next(index_t const ply)
+{
+    uint16_t const pick = picks[ply];
+    uint16_t best, i;
+    stack_move_t move;
+
+    if (pick >= ends[ply]) {
+        return nullptr;
+    }
+
+    best = pick;
+    for (i = pick + 1; i < ends[ply]; i++) {
+        if (moves[i].score > moves[best].score) {
+            best = i;
+        }
+    }
+
+    if (best != pick) {
+        move = moves[best];
+        memmove(&moves[pick + 1], &moves[pick], (best - pick) * sizeof(stack_move_t));
+        moves[pick] = move;
+    }
+
+    return &moves[picks[ply]++];
+
+} // move_stack_t::next(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// See if a move is in a ply's list
+Bool move_stack_t::contains(index_t const ply, index_t const from, index_t const to) const
+{
+    for (uint16_t i = first(ply); i < ends[ply]; i++) {
+        if ((from == moves[i].move.from) && (to == moves[i].move.to)) {
+            return True;
+        }
+    }
+
+    return False;
+
+} // move_stack_t::contains(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// See if any of a ply's moves didn't fit on the stack
+Bool move_stack_t::spilled(index_t const ply) const
+{
+    return 0 != (spills & (1 << ply));
+
+} // move_stack_t::spilled(index_t const ply)
+
+#endif // ENA_MOVE_LIST
@@ -0,0 +1,72 @@
+/**
+ * movestack.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The move_stack_t arena that each ply's moves are generated into so
+ * that they can be searched in the order of their scores. The list for
+ * each ply starts where the list for the ply before it ends.
+ *
+ */
+#ifndef MOVESTACK_INCL
+#define MOVESTACK_INCL
+
+#ifdef ENA_MOVE_LIST
+
+#include <stdint.h>
+
+static_assert(MOVE_STACK <= 0xFFFF, "MOVE_STACK must fit in 16 bits");
+
+////////////////////////////////////////////////////////////////////////////////////////
+// a move on the move stack and the score used to order it
+struct stack_move_t {
+    pmove_t     move;           // the move and its MOVE_XXX flags
+    int16_t     score;          // one of the ORDER_XXX scores or 0 for a quiet move
+
+};  // stack_move_t
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the move stack
+class move_stack_t {
+    private:
+    stack_move_t    moves[MOVE_STACK];
+
+    // The entry after the last move in each ply's list, and the next move to
+    // pick from it. game.ply is 3 bits so there are at most 8 plies.
+    uint16_t        ends[8];
+    uint16_t        picks[8];
+
+    // One bit per ply set when a move didn't fit on the stack
+    uint8_t         spills;
+
+    // Get the first entry of a ply's list
+    uint16_t first(index_t const ply) const;
+
+    public:
+    move_stack_t();
+
+    // Start an empty list for a ply after the list for the ply before it
+    void begin(index_t const ply);
+
+    // Add a move to the end of a ply's list. When the stack is full the move
+    // with the lowest score is left off and the ply is marked as having spilled.
+    void add(index_t const ply, index_t const from, index_t const to, uint8_t const flags, int16_t const score);
+
+    // Take the move with the highest score that hasn't been picked yet from a ply's
+    // list. Moves with the same score are picked in the order they were added.
+    //
+    // returns the move or nullptr when all of the moves have been picked
+    stack_move_t const *next(index_t const ply);
+
+    // See if a move is in a ply's list
+    Bool contains(index_t const ply, index_t const from, index_t const to) const;
+
+    // See if any of a ply's moves didn't fit on the stack
+    Bool spilled(index_t const ply) const;
+
+};  // move_stack_t
+
+#endif // ENA_MOVE_LIST
+
+#endif // MOVESTACK_INCL
@@ -19,19 +19,116 @@ options_t::options_t() :
     live_update(False),
 
     profiling(False), 
+    benchmark(False),
     continuous(False),
     integrate(True),
     openbook(False),
-    shuffle_pieces(True),
+    shuffle_pieces(False),
 
     white_human(False),
     black_human(False),
     alpha_beta_pruning(True),
+    trans_table(True),
+    iterative(True),
+    negamax(True),
+    pvs(True),
+    qsearch(True),
+    legal_moves(True),
+    move_order(True),
+    #ifdef ENA_MOVE_LIST
+    move_list(True),
+    #else
+    move_list(False),
+    #endif
+    quiet_order(True),
+    random_ties(False),
     seed(PRN_SEED),
     print_level(Debug1),
     time_limit(0),
     mistakes(0),
     randskip(0)
+#ifdef ENA_SMP
+    , threads(1)
+    , root_split(False)
+#endif
+#ifdef ENA_SELFPLAY
+    , selfplay_games(0)
+    , selfplay_threads(1)
+#endif
+#ifdef ENA_MATCH
+    , per_side(False)
+    , match(False)
+    , sprt_elo(20)
+    , tt_salt(0)
+    , materialBonus(1)
+    , centerBonus(1)
+    , kingBonus(1)
+    , mobilityBonus(1)
+#endif
 {
-
+#ifdef ENA_MATCH
+    get_side(sides[White]);
+    get_side(sides[Black]);
+#endif
 }
+
+
+#ifdef ENA_MATCH
+////////////////////////////////////////////////////////////////////////////////////////
+// Get a key for these settings that is the same for every side_options_t with the
+// same settings. The settings are hashed the same way as the FNV-1a hash.
+uint64_t side_options_t::key() const
+{
+    uint8_t const bytes[] = {
+        uint8_t(maxply), uint8_t(max_quiescent_ply),
+        uint8_t(alpha_beta_pruning), uint8_t(pvs), uint8_t(qsearch), uint8_t(integrate),
+        materialBonus, centerBonus, kingBonus, mobilityBonus
+    };
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (uint8_t const byte : bytes) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+
+    return hash;
+
+} // side_options_t::key()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Copy the settings that each side can have out of these options
+void options_t::get_side(side_options_t &side) const
+{
+    side.maxply = maxply;
+    side.max_quiescent_ply = max_quiescent_ply;
+    side.alpha_beta_pruning = alpha_beta_pruning;
+    side.pvs = pvs;
+    side.qsearch = qsearch;
+    side.integrate = integrate;
+    side.materialBonus = materialBonus;
+    side.centerBonus = centerBonus;
+    side.kingBonus = kingBonus;
+    side.mobilityBonus = mobilityBonus;
+
+} // options_t::get_side(side_options_t &side)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Search with the settings for one side. The transposition table entries found
+// with these settings are kept apart from the ones found with any others.
+void options_t::set_side(side_options_t const &side)
+{
+    maxply = min((long) side.maxply, (long) max_max_ply);
+    max_quiescent_ply = min((long) side.max_quiescent_ply, (long) max_max_ply);
+    alpha_beta_pruning = side.alpha_beta_pruning;
+    pvs = side.pvs;
+    qsearch = side.qsearch;
+    integrate = side.integrate;
+    materialBonus = side.materialBonus;
+    centerBonus = side.centerBonus;
+    kingBonus = side.kingBonus;
+    mobilityBonus = side.mobilityBonus;
+    tt_salt = side.key();
+
+} // options_t::set_side(side_options_t const &side)
+#endif
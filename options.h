@@ -12,6 +12,28 @@
 
 #include <stdint.h>
 
+#ifdef ENA_MATCH
+////////////////////////////////////////////////////////////////////////////////////////
+// The settings that White and Black can each search with on their own turns
+struct side_options_t {
+    uint8_t     maxply : 4,                 // The nominal max ply level
+                max_quiescent_ply : 4;      // The maximum ply level to continue if a piece was taken on a move
+    uint8_t     alpha_beta_pruning : 1,     // Use alpha-beta pruning when True
+                pvs : 1,                    // Use principal variation search with negamax when True
+                qsearch : 1,                // Search only captures and promotions past maxply with negamax when True
+                integrate : 1;              // Integrate recursive return values when True
+    uint8_t     materialBonus,              // The board evaluation multipliers
+                centerBonus,
+                kingBonus,
+                mobilityBonus;
+
+    // Get a key for these settings that is the same for every side_options_t with the same settings
+    uint64_t key() const;
+
+};  // side_options_t
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // The settings for a game
 struct options_t {
@@ -29,19 +51,52 @@ public:
                      random : 1,    // Add randomness to the game when True
                 live_update : 1,    // Periodically update the LED strip and other external indicators as we choose a move
                   profiling : 1,    // We profiling the engine when True
+                  benchmark : 1,    // Run the benchmark before playing when True
                  continuous : 1,    // True if we play games continuously one after another
                   integrate : 1,    // Integrate recursive return values when True
                    openbook : 1,    // Use opening book when True
              shuffle_pieces : 1,    // True if we want to process the pieces in a random order
                 white_human : 1,    // Flags indicating if white player is human or not
                 black_human : 1,    // Flags indicating if black player is human or not
-         alpha_beta_pruning : 1;    // Use alpha-beta pruning when True
+         alpha_beta_pruning : 1,    // Use alpha-beta pruning when True
+                trans_table : 1,    // Use the transposition table when True
+                  iterative : 1,    // Use iterative deepening up to maxply when True
+                    negamax : 1,    // Search only the side to move using negamax when True
+                        pvs : 1,    // Use principal variation search with negamax when True
+                    qsearch : 1,    // Search only captures and promotions past maxply with negamax when True
+                legal_moves : 1,    // Generate only the legal moves for the side to move when True
+                 move_order : 1,    // Search the best move, then captures and promotions, then quiet moves when True
+                  move_list : 1,    // Generate the moves into the move stack and search them by score when True
+                quiet_order : 1,    // Order the quiet moves by the killer moves and history counts when True
+                random_ties : 1;    // Choose between moves with equal values at random when True
 
     uint32_t    seed;               // The starting seed hash for prn's
     print_t     print_level;        // The verbosity setting for the level of output
     uint32_t    time_limit;         // Optional time limit in ms if != 0
     index_t     mistakes;           // The percentage of times the engine will make a mistake
     index_t     randskip;           // Randomly skip ply depths percentage
+#ifdef ENA_SMP
+    index_t     threads;            // The number of threads that search each move
+    Bool        root_split;         // Share the root moves out between the threads instead of using Lazy SMP when True
+#endif
+#ifdef ENA_SELFPLAY
+    uint32_t    selfplay_games;     // The number of self-play games to play if != 0
+    index_t     selfplay_threads;   // The number of threads playing the self-play games
+#endif
+#ifdef ENA_MATCH
+    Bool        per_side;           // Search with sides[White] on White's turns and sides[Black] on Black's when True
+    Bool        match;              // Play a match between sides[White] and sides[Black] that alternates colors when True
+    index_t     sprt_elo;           // The match stops when one of the settings is this much stronger or weaker
+    side_options_t sides[2];        // The settings for each side, indexed by Color
+    uint64_t    tt_salt;            // Keeps the transposition table entries apart for each side's settings
+
+    // Adjustable multipiers to alter the importance of mobility, center proximity,
+    // material, and king bonus metrics during board evaluation. Season to taste.
+    uint8_t     materialBonus;
+    uint8_t     centerBonus;
+    uint8_t     kingBonus;
+    uint8_t     mobilityBonus;
+#endif
 
 
     // This stuff stays the same at runtime during the game, and can't be modified during the game
@@ -49,17 +104,30 @@ public:
     static uint32_t constexpr move_limit    = 100;  // The maximum number of moves allowed in a full game
     static int      constexpr low_mem_limit = 810;  // The amount of memory used as reported by the compiler
 
+#ifndef ENA_MATCH
     // Adjustable multipiers to alter the importance of mobility, center proximity,
     // material, and king bonus metrics during board evaluation. Season to taste.
     static long  constexpr  materialBonus =  1L;
     static long  constexpr  centerBonus   =  1L;
     static long  constexpr  kingBonus     =  1L;
     static long  constexpr  mobilityBonus =  1L;
+#endif
+
+    // The margin added to a capture's value before it is skipped in the quiescent search
+    static long  constexpr  deltaMargin   =  2000L;
 
 public:
 
     options_t();
 
+#ifdef ENA_MATCH
+    // Copy the settings that each side can have out of these options
+    void get_side(side_options_t &side) const;
+
+    // Search with the settings for one side
+    void set_side(side_options_t const &side);
+#endif
+
 };  // options_t
 
 #endif  // OPTIONS_INCL
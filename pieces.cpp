@@ -33,24 +33,405 @@ static offset_t const bishop_offsets[4] PROGMEM = {
     { -1, -1 }, { -1,  1 }, {  1, -1 }, {  1,  1 }
 };
 
-extern game_t game;
+// The spots a knight or a king on each spot attacks, one bit per spot (col + row * 8)
+static uint64_t constexpr knight_attacks[64] PROGMEM = {
+    0x0000000000020400ULL, 0x0000000000050800ULL, 0x00000000000A1100ULL, 0x0000000000142200ULL,
+    0x0000000000284400ULL, 0x0000000000508800ULL, 0x0000000000A01000ULL, 0x0000000000402000ULL,
+    0x0000000002040004ULL, 0x0000000005080008ULL, 0x000000000A110011ULL, 0x0000000014220022ULL,
+    0x0000000028440044ULL, 0x0000000050880088ULL, 0x00000000A0100010ULL, 0x0000000040200020ULL,
+    0x0000000204000402ULL, 0x0000000508000805ULL, 0x0000000A1100110AULL, 0x0000001422002214ULL,
+    0x0000002844004428ULL, 0x0000005088008850ULL, 0x000000A0100010A0ULL, 0x0000004020002040ULL,
+    0x0000020400040200ULL, 0x0000050800080500ULL, 0x00000A1100110A00ULL, 0x0000142200221400ULL,
+    0x0000284400442800ULL, 0x0000508800885000ULL, 0x0000A0100010A000ULL, 0x0000402000204000ULL,
+    0x0002040004020000ULL, 0x0005080008050000ULL, 0x000A1100110A0000ULL, 0x0014220022140000ULL,
+    0x0028440044280000ULL, 0x0050880088500000ULL, 0x00A0100010A00000ULL, 0x0040200020400000ULL,
+    0x0204000402000000ULL, 0x0508000805000000ULL, 0x0A1100110A000000ULL, 0x1422002214000000ULL,
+    0x2844004428000000ULL, 0x5088008850000000ULL, 0xA0100010A0000000ULL, 0x4020002040000000ULL,
+    0x0400040200000000ULL, 0x0800080500000000ULL, 0x1100110A00000000ULL, 0x2200221400000000ULL,
+    0x4400442800000000ULL, 0x8800885000000000ULL, 0x100010A000000000ULL, 0x2000204000000000ULL,
+    0x0004020000000000ULL, 0x0008050000000000ULL, 0x00110A0000000000ULL, 0x0022140000000000ULL,
+    0x0044280000000000ULL, 0x0088500000000000ULL, 0x0010A00000000000ULL, 0x0020400000000000ULL
+};
+
+static uint64_t constexpr king_attacks[64] PROGMEM = {
+    0x0000000000000302ULL, 0x0000000000000705ULL, 0x0000000000000E0AULL, 0x0000000000001C14ULL,
+    0x0000000000003828ULL, 0x0000000000007050ULL, 0x000000000000E0A0ULL, 0x000000000000C040ULL,
+    0x0000000000030203ULL, 0x0000000000070507ULL, 0x00000000000E0A0EULL, 0x00000000001C141CULL,
+    0x0000000000382838ULL, 0x0000000000705070ULL, 0x0000000000E0A0E0ULL, 0x0000000000C040C0ULL,
+    0x0000000003020300ULL, 0x0000000007050700ULL, 0x000000000E0A0E00ULL, 0x000000001C141C00ULL,
+    0x0000000038283800ULL, 0x0000000070507000ULL, 0x00000000E0A0E000ULL, 0x00000000C040C000ULL,
+    0x0000000302030000ULL, 0x0000000705070000ULL, 0x0000000E0A0E0000ULL, 0x0000001C141C0000ULL,
+    0x0000003828380000ULL, 0x0000007050700000ULL, 0x000000E0A0E00000ULL, 0x000000C040C00000ULL,
+    0x0000030203000000ULL, 0x0000070507000000ULL, 0x00000E0A0E000000ULL, 0x00001C141C000000ULL,
+    0x0000382838000000ULL, 0x0000705070000000ULL, 0x0000E0A0E0000000ULL, 0x0000C040C0000000ULL,
+    0x0003020300000000ULL, 0x0007050700000000ULL, 0x000E0A0E00000000ULL, 0x001C141C00000000ULL,
+    0x0038283800000000ULL, 0x0070507000000000ULL, 0x00E0A0E000000000ULL, 0x00C040C000000000ULL,
+    0x0302030000000000ULL, 0x0705070000000000ULL, 0x0E0A0E0000000000ULL, 0x1C141C0000000000ULL,
+    0x3828380000000000ULL, 0x7050700000000000ULL, 0xE0A0E00000000000ULL, 0xC040C00000000000ULL,
+    0x0203000000000000ULL, 0x0507000000000000ULL, 0x0A0E000000000000ULL, 0x141C000000000000ULL,
+    0x2838000000000000ULL, 0x5070000000000000ULL, 0xA0E0000000000000ULL, 0x40C0000000000000ULL
+};
+
+// Read one of the attack masks from program memory
+static uint64_t read_mask(uint64_t const * const ptr) {
+    return uint64_t(pgm_read_dword((uint32_t const *) ptr)) |
+          (uint64_t(pgm_read_dword((uint32_t const *) ptr + 1)) << 32);
+}
+
+
+// Get the spots in a mask that hold one of a side's pieces of a type
+static uint64_t mask_of(uint64_t mask, Piece const type, Color const side) {
+    #ifdef ENA_BITBOARD
+    return mask & engine->board.pieces(type, side);
+    #else
+    uint64_t found = 0;
+    index_t spot;
+    Piece p;
+
+    while (0 != mask) {
+        spot = __builtin_ctzll(mask);
+        p = engine->board.get(spot);
+        if ((type == getType(p)) && (side == getSide(p))) { found |= 1ULL << spot; }
+        mask &= mask - 1;
+    }
+
+    return found;
+    #endif
+}
+
+
+// Get the spots that a side's pawns would attack a spot from. White's pawns
+// move up the board (to lower rows) so they attack from the row below.
+static uint64_t pawn_mask(index_t const spot, Color const side) {
+    index_t const col = spot % 8;
+    index_t const row = spot / 8 + (White == side ? +1 : -1);
+    uint64_t mask = 0;
+
+    if (row >= 0 && row <= 7) {
+        if (col > 0) { mask |= 1ULL << (col - 1 + row * 8); }
+        if (col < 7) { mask |= 1ULL << (col + 1 + row * 8); }
+    }
+
+    return mask;
+}
+
+
+#ifndef ENA_MAGIC
+// Walk the rays from a spot and see if the first piece on any of them is
+// one of a side's sliding pieces of either type
+static Bool ray_has(index_t const spot, offset_t const * const ptr, Piece const type, Color const side) {
+    index_t i, x, y;
+    Piece p;
+
+    for (i = 0; i < 4; i++) {
+        x = spot % 8 + index_t(pgm_read_byte(&ptr[i].x));
+        y = spot / 8 + index_t(pgm_read_byte(&ptr[i].y));
+
+        while (isValidPos(x, y)) {
+            p = engine->board.get(x + y * 8);
+            if (!isEmpty(p)) {
+                if ((side == getSide(p)) && ((type == getType(p)) || (Queen == getType(p)))) {
+                    return True;
+                }
+                break;
+            }
+            x += index_t(pgm_read_byte(&ptr[i].x));
+            y += index_t(pgm_read_byte(&ptr[i].y));
+        }
+    }
+
+    return False;
+}
+#endif
+
+
+// See if a spot is attacked by any of a side's pieces. The knights and the king
+// are found with the attack tables, the pawns by looking at the two spots they
+// would attack from, and the sliding pieces by walking the rays out from the spot
+// (or with the magic tables when we have them).
+Bool is_square_attacked(index_t const square, Color const by_side) {
+    if (0 != mask_of(pawn_mask(square, by_side), Pawn, by_side)) { return True; }
+    if (0 != mask_of(read_mask(&knight_attacks[square]), Knight, by_side)) { return True; }
+    if (0 != mask_of(read_mask(&king_attacks[square]), King, by_side)) { return True; }
+
+    #ifdef ENA_MAGIC
+    uint64_t const queens = engine->board.pieces(Queen, by_side);
+    if (0 != (magic.rook(square, engine->board.occupied()) & (engine->board.pieces(Rook, by_side) | queens))) { return True; }
+    if (0 != (magic.bishop(square, engine->board.occupied()) & (engine->board.pieces(Bishop, by_side) | queens))) { return True; }
+    #else
+    if (ray_has(square, rook_offsets, Rook, by_side)) { return True; }
+    if (ray_has(square, bishop_offsets, Bishop, by_side)) { return True; }
+    #endif
+
+    return False;
+
+} // is_square_attacked(index_t const square, Color const by_side)
+
+
+// Find the pieces giving check to a side's King and the pieces pinned to it.
+// The rays out from the King find the sliding pieces giving check, and the
+// pieces of our own that are the only thing between the King and one of them.
+void find_checks_and_pins(legal_t &legal, Color const side) {
+    index_t const king = (White == side) ? engine->game.wking : engine->game.bking;
+    uint64_t checks, ray, found;
+    index_t i, dx, dy, x, y, pin, count;
+    offset_t const *ptr;
+    Piece p;
+
+    checks = 0;
+    count = 0;
+    legal.pinned = 0;
+
+    for (i = 0; i < 8; i++) {
+        ptr = (i < 4) ? &rook_offsets[i] : &bishop_offsets[i - 4];
+        dx = index_t(pgm_read_byte(&ptr->x));
+        dy = index_t(pgm_read_byte(&ptr->y));
+        x = king % 8 + dx;
+        y = king / 8 + dy;
+        ray = 0;
+        pin = -1;
+
+        while (isValidPos(x, y)) {
+            p = engine->board.get(x + y * 8);
+            ray |= 1ULL << (x + y * 8);
+
+            if (!isEmpty(p)) {
+                if (side == getSide(p)) {
+                    // A second piece of our own means nothing on this ray is pinned
+                    if (-1 != pin) { break; }
+                    pin = x + y * 8;
+                }
+                else {
+                    if ((((i < 4) ? Rook : Bishop) == getType(p)) || (Queen == getType(p))) {
+                        if (-1 == pin) {
+                            checks |= ray;
+                            count++;
+                        }
+                        else {
+                            legal.pinned |= 1ULL << pin;
+                        }
+                    }
+                    break;
+                }
+            }
+
+            x += dx;
+            y += dy;
+        }
+    }
+
+    found = mask_of(read_mask(&knight_attacks[king]), Knight, !side) | mask_of(pawn_mask(king, !side), Pawn, !side);
+    checks |= found;
+    count += __builtin_popcountll(found);
+
+    // Moves other than the King's have to take the piece giving check or block it,
+    // and only the King can move out of a double check
+    legal.evasions = (0 == count) ? ~0ULL : (1 == count) ? checks : 0;
+    legal.king = king;
+    legal.side = side;
+    legal.checkers = min(count, 2);
+
+} // find_checks_and_pins(legal_t &legal, Color const side)
+
+
+// See if a spot is on the ray that starts at the King and passes through another spot
+static Bool on_ray(index_t const king, index_t const through, index_t const spot) {
+    index_t const dx1 = (through % 8) - (king % 8);
+    index_t const dy1 = (through / 8) - (king / 8);
+    index_t const dx2 = (spot % 8) - (king % 8);
+    index_t const dy2 = (spot / 8) - (king / 8);
+
+    // The cross product is 0 when the spots are on the same line, and the dot
+    // product is positive when they are on the same side of the King
+    return (dx1 * dy2 == dy1 * dx2) && (dx1 * dx2 + dy1 * dy2 > 0);
+
+} // on_ray(index_t const king, index_t const through, index_t const spot)
+
+
+// See if a generated move is legal for the side that the checks and pins were found for.
+// King moves and en-passant captures are tried on the board since they can uncover a
+// check that the pins don't show. Any other move has to get out of check if we are in
+// check, and a pinned piece has to stay between the King and the piece pinning it.
+Bool is_legal(piece_gen_t const &gen) {
+    legal_t const &legal = *gen.legal;
+    index_t const to = gen.move.to;
+    index_t taken;
+    Piece piece;
+    Bool result;
+
+    if (King == gen.type) {
+        engine->board.set(gen.move.from, Empty);
+        result = !is_square_attacked(to, !gen.side);
+        engine->board.set(gen.move.from, gen.piece);
+        return result;
+    }
+
+    if ((Pawn == gen.type) && (gen.col != (to % 8)) && isEmpty(engine->board.get(to))) {
+        taken = (to % 8) + gen.row * 8;
+        piece = engine->board.get(taken);
+        engine->board.set(gen.move.from, Empty);
+        engine->board.set(taken, Empty);
+        engine->board.set(to, gen.piece);
+        result = !is_square_attacked(legal.king, !gen.side);
+        engine->board.set(to, Empty);
+        engine->board.set(taken, piece);
+        engine->board.set(gen.move.from, gen.piece);
+        return result;
+    }
+
+    if (0 == (legal.evasions & (1ULL << to))) {
+        return False;
+    }
+
+    if (0 != (legal.pinned & (1ULL << gen.move.from))) {
+        return on_ray(legal.king, gen.move.from, to);
+    }
+
+    return True;
+
+} // is_legal(piece_gen_t const &gen)
+
+
+// The move generators below are templates on the side of the piece being moved so
+// that the direction its pawns move and the checks for which pieces are its own are
+// constants in each one. They are also templates on the visitor that each move is
+// passed on to so that it is called directly instead of through gen.callme.
+// add_piece_moves(...) picks the one for the piece's side and the visitor.
+
+// Pass a generated move on to the visitor unless we are only generating
+// legal moves for this side and it isn't one
+//
+// returns 1 if the move was passed on, 0 if not
+template <Color Side, generator_t *Visit>
+static index_t visit(piece_gen_t &gen) {
+    if ((nullptr != gen.legal) && (Side == gen.legal->side) && !is_legal(gen)) {
+        return 0;
+    }
+
+    Visit(gen);
+    return 1;
+
+} // visit(piece_gen_t &gen)
+
 
 // Function to check for forward moves
-index_t check_fwd(piece_gen_t &gen, index_t const col, index_t const row) {
+template <Color Side, generator_t *Visit>
+static index_t check_fwd(piece_gen_t &gen, index_t const col, index_t const row) {
     if (!isValidPos(col, row)) { return 0; }
     gen.move.to = col + row * 8;
-    if (!isEmpty(board.get(gen.move.to))) { return 0; }
-    gen.callme(gen);
-    return 1;
+    if (!isEmpty(engine->board.get(gen.move.to))) { return 0; }
+    return visit<Side, Visit>(gen);
 };
 
 
-index_t add_pawn_moves(piece_gen_t &gen) {
+// Check for an en-passant capture by a pawn onto the column next to it
+template <Color Side, generator_t *Visit>
+static index_t check_en_passant(piece_gen_t &gen, index_t const to_col) {
+    index_t last_move_to_col, last_move_to_row, last_move_from_row;
+    Piece op;
+
+    // // Check for en-passant
+    // last_move_from_row = engine->game.last_move.from / 8;
+    // last_move_to_col = engine->game.last_move.to % 8;
+    // last_move_to_row = engine->game.last_move.to / 8;
+
+    // if (last_move_to_col == to_col && last_move_to_row == gen.row) {
+    //     if (abs(int(last_move_from_row) - int(last_move_to_row)) > 1) {
+    //         op = engine->board.get(last_move_to_col + gen.row * 8);
+    //         if (Pawn == getType(op) && getSide(op) != gen.side) {
+    //             gen.move.to = to_col + (gen.row + (gen.whites_turn ? -1 : 1)) * 8;
+    //             gen.callme(gen);
+    //             count++;
+    //         }
+    //     }
+    // }
+
+    // Check for en-passant candidate move
+    last_move_from_row = engine->game.last_move.from / 8;
+    last_move_to_col   = engine->game.last_move.to % 8;
+    last_move_to_row   = engine->game.last_move.to / 8;
+
+    if (last_move_to_col == to_col && last_move_to_row == gen.row) {
+        // Ensure that the enemy pawn moved exactly two squares (a two-square jump)
+        if (abs(int(last_move_from_row) - int(last_move_to_row)) == 2) {
+            op = engine->board.get(last_move_to_col + gen.row * 8);
+            // Verify that the enemy pawn is indeed a pawn and of the opposite side.
+            if (Pawn == getType(op) && getSide(op) != Side) {
+                // Generate candidate move: the destination square is where the pawn would land after capturing en-passant.
+                gen.move.to = to_col + (gen.row + ((White == Side) ? -1 : +1)) * 8;
+                return visit<Side, Visit>(gen);
+            }
+        }
+    }
+
+    return 0;
+
+} // check_en_passant(piece_gen_t &gen, index_t const to_col)
+
+
+#ifdef ENA_BITBOARD
+
+// Pass each of the spots in a mask on to the visitor as a move for the piece
+template <Color Side, generator_t *Visit>
+static index_t visit_mask(piece_gen_t &gen, uint64_t mask) {
+    index_t count = 0;
+
+    while (0 != mask) {
+        // See if the turn has timed out
+        if (timeout()) { return count; }
+
+        gen.move.to = __builtin_ctzll(mask);
+        count += visit<Side, Visit>(gen);
+        mask &= mask - 1;
+    }
+
+    return count;
+
+} // visit_mask(piece_gen_t &gen, uint64_t mask)
+
+
+// The pawn moves using the bitboards. The pushes are the pawn's bit shifted one
+// row forward onto an empty spot, and a second row if it hasn't moved yet.
+template <Color Side, generator_t *Visit>
+static index_t add_pawn_moves(piece_gen_t &gen) {
+    // Stack Management
+    // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
+    // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
+    uint64_t empty, push;
+    index_t count;
+
+    //  Check for low stack space
+    if (check_mem(ADD_MOVES)) { return 0; }
+
+    // Now we can alter local variables! 😎 
+
+    empty = ~engine->board.occupied();
+    push = ((White == Side) ? (1ULL << gen.move.from) >> 8 : (1ULL << gen.move.from) << 8) & empty;
+    if ((0 != push) && !hasMoved(gen.piece)) {
+        push |= ((White == Side) ? push >> 8 : push << 8) & empty;
+    }
+
+    // The spots this pawn attacks are the spots the other side's pawns would attack it from
+    count = visit_mask<Side, Visit>(gen, push);
+    count += visit_mask<Side, Visit>(gen, pawn_mask(gen.move.from, !Side) & engine->board.side(!Side));
+
+    if (timeout()) { return count; }
+
+    if (gen.col > 0) { count += check_en_passant<Side, Visit>(gen, gen.col - 1); }
+    if (gen.col < 7) { count += check_en_passant<Side, Visit>(gen, gen.col + 1); }
+
+    return count;
+
+} // add_pawn_moves(piece_gen_t &gen)
+
+#else
+
+template <Color Side, generator_t *Visit>
+static index_t add_pawn_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
     index_t to_col, to_row, count, i;
-    index_t last_move_to_col, last_move_to_row, last_move_from_row;
     Piece op;
 
     //  Check for low stack space
@@ -60,21 +441,21 @@ index_t add_pawn_moves(piece_gen_t &gen) {
 
     // See if we can move 1 spot in front of this pawn
     to_col = gen.col;
-    to_row = gen.row + (gen.whites_turn ? -1 : +1);
+    to_row = gen.row + ((White == Side) ? -1 : +1);
     gen.move.to = to_col + to_row * 8;
 
     // Count the number of available moves
     count = 0;
 
     // Check 1 row ahead
-    count += check_fwd(gen, to_col, to_row);
+    count += check_fwd<Side, Visit>(gen, to_col, to_row);
 
     if (timeout()) { return count; }
 
-    // Check 2 rows ahead
-    if (!hasMoved(board.get(gen.move.from))) {
-        to_row += (gen.whites_turn ? -1 : +1);
-        count += check_fwd(gen, to_col, to_row);
+    // Check 2 rows ahead if the spot 1 row ahead is empty
+    if (!hasMoved(engine->board.get(gen.move.from)) && isValidPos(to_col, to_row) && isEmpty(engine->board.get(to_col + to_row * 8))) {
+        to_row += ((White == Side) ? -1 : +1);
+        count += check_fwd<Side, Visit>(gen, to_col, to_row);
     }
 
     if (timeout()) { return count; }
@@ -85,50 +466,16 @@ index_t add_pawn_moves(piece_gen_t &gen) {
         if (timeout()) { return count; }
 
         to_col = gen.col + i;
-        to_row = gen.row + (gen.whites_turn ? -1 : +1);
+        to_row = gen.row + ((White == Side) ? -1 : +1);
         gen.move.to = to_col + to_row * 8;
         if (isValidPos(to_col, to_row)) {
             // Check diagonal piece
-            op = board.get(gen.move.to);
-            if (!isEmpty(op) && getSide(op) != gen.side) {
-                gen.callme(gen);
-                count++;
+            op = engine->board.get(gen.move.to);
+            if (!isEmpty(op) && getSide(op) != Side) {
+                count += visit<Side, Visit>(gen);
             }
 
-            // // Check for en-passant
-            // last_move_from_row = game.last_move.from / 8;
-            // last_move_to_col = game.last_move.to % 8;
-            // last_move_to_row = game.last_move.to / 8;
-
-            // if (last_move_to_col == to_col && last_move_to_row == gen.row) {
-            //     if (abs(int(last_move_from_row) - int(last_move_to_row)) > 1) {
-            //         op = board.get(last_move_to_col + gen.row * 8);
-            //         if (Pawn == getType(op) && getSide(op) != gen.side) {
-            //             gen.move.to = to_col + (gen.row + (gen.whites_turn ? -1 : 1)) * 8;
-            //             gen.callme(gen);
-            //             count++;
-            //         }
-            //     }
-            // }
-
-            // Check for en-passant candidate move
-            last_move_from_row = game.last_move.from / 8;
-            last_move_to_col   = game.last_move.to % 8;
-            last_move_to_row   = game.last_move.to / 8;
-
-            if (last_move_to_col == to_col && last_move_to_row == gen.row) {
-                // Ensure that the enemy pawn moved exactly two squares (a two-square jump)
-                if (abs(int(last_move_from_row) - int(last_move_to_row)) == 2) {
-                    op = board.get(last_move_to_col + gen.row * 8);
-                    // Verify that the enemy pawn is indeed a pawn and of the opposite side.
-                    if (Pawn == getType(op) && getSide(op) != gen.side) {
-                        // Generate candidate move: the destination square is where the pawn would land after capturing en-passant.
-                        gen.move.to = to_col + (gen.row + (gen.whites_turn ? -1 : +1)) * 8;
-                        gen.callme(gen);
-                        count++;
-                    }
-                }
-            }
+            count += check_en_passant<Side, Visit>(gen, to_col);
         }
     }
 
@@ -136,8 +483,11 @@ index_t add_pawn_moves(piece_gen_t &gen) {
 
 } // add_pawn_moves(piece_gen_t &gen)
 
+#endif
+
 
-index_t gen_moves(piece_gen_t &gen, offset_t const * const ptr, index_t const num_dirs, index_t const num_iter) {
+template <Color Side, generator_t *Visit>
+static index_t gen_moves(piece_gen_t &gen, offset_t const * const ptr, index_t const num_dirs, index_t const num_iter) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -167,15 +517,13 @@ index_t gen_moves(piece_gen_t &gen, offset_t const * const ptr, index_t const nu
             }
 
             gen.move.to = x + y * 8;
-            other_piece = board.get(gen.move.to);
+            other_piece = engine->board.get(gen.move.to);
 
             if (isEmpty(other_piece)) {
-                gen.callme(gen);
-                count++;
+                count += visit<Side, Visit>(gen);
             }
-            else if (getSide(other_piece) != gen.side) {
-                gen.callme(gen);
-                count++;
+            else if (getSide(other_piece) != Side) {
+                count += visit<Side, Visit>(gen);
                 break;
             }
             else {
@@ -192,7 +540,8 @@ index_t gen_moves(piece_gen_t &gen, offset_t const * const ptr, index_t const nu
 } // gen_moves(...)
 
 
-index_t add_knight_moves(piece_gen_t &gen) {
+template <Color Side, generator_t *Visit>
+static index_t add_knight_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -202,12 +551,17 @@ index_t add_knight_moves(piece_gen_t &gen) {
 
     // Now we can alter local variables! 😎 
 
-    return gen_moves(gen, (offset_t *) pgm_get_far_address(knight_offsets), ARRAYSZ(knight_offsets), 1);
+    #ifdef ENA_BITBOARD
+    return visit_mask<Side, Visit>(gen, read_mask(&knight_attacks[gen.move.from]) & ~engine->board.side(Side));
+    #else
+    return gen_moves<Side, Visit>(gen, (offset_t *) pgm_get_far_address(knight_offsets), ARRAYSZ(knight_offsets), 1);
+    #endif
 
 } // add_knight_moves(piece_gen_t &gen)
 
 
-index_t add_rook_moves(piece_gen_t &gen) {
+template <Color Side, generator_t *Visit>
+static index_t add_rook_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -217,12 +571,17 @@ index_t add_rook_moves(piece_gen_t &gen) {
 
     // Now we can alter local variables! 😎 
 
-    return gen_moves(gen, (offset_t *) pgm_get_far_address(rook_offsets), ARRAYSZ(rook_offsets), 7);
+    #ifdef ENA_MAGIC
+    return visit_mask<Side, Visit>(gen, magic.rook(gen.move.from, engine->board.occupied()) & ~engine->board.side(Side));
+    #else
+    return gen_moves<Side, Visit>(gen, (offset_t *) pgm_get_far_address(rook_offsets), ARRAYSZ(rook_offsets), 7);
+    #endif
 
 } // add_rook_moves(piece_gen_t &gen)
 
 
-index_t add_bishop_moves(piece_gen_t &gen) {
+template <Color Side, generator_t *Visit>
+static index_t add_bishop_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -232,12 +591,17 @@ index_t add_bishop_moves(piece_gen_t &gen) {
 
     // Now we can alter local variables! 😎 
 
-    return gen_moves(gen, (offset_t *) pgm_get_far_address(bishop_offsets), ARRAYSZ(bishop_offsets), 7);
+    #ifdef ENA_MAGIC
+    return visit_mask<Side, Visit>(gen, magic.bishop(gen.move.from, engine->board.occupied()) & ~engine->board.side(Side));
+    #else
+    return gen_moves<Side, Visit>(gen, (offset_t *) pgm_get_far_address(bishop_offsets), ARRAYSZ(bishop_offsets), 7);
+    #endif
 
 } // add_bishop_moves(piece_gen_t &gen)
 
 
-index_t add_king_moves(piece_gen_t &gen) {
+template <Color Side, generator_t *Visit>
+static index_t add_king_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -255,37 +619,40 @@ index_t add_king_moves(piece_gen_t &gen) {
     // Count the number of available moves
     count = 0;
 
-    count += gen_moves(gen, (offset_t *) pgm_get_far_address(rook_offsets), ARRAYSZ(rook_offsets), 1);
-    count += gen_moves(gen, (offset_t *) pgm_get_far_address(bishop_offsets), ARRAYSZ(bishop_offsets), 1);
+    #ifdef ENA_BITBOARD
+    count += visit_mask<Side, Visit>(gen, read_mask(&king_attacks[gen.move.from]) & ~engine->board.side(Side));
+    #else
+    count += gen_moves<Side, Visit>(gen, (offset_t *) pgm_get_far_address(rook_offsets), ARRAYSZ(rook_offsets), 1);
+    count += gen_moves<Side, Visit>(gen, (offset_t *) pgm_get_far_address(bishop_offsets), ARRAYSZ(bishop_offsets), 1);
+    #endif
 
-    // check for castling
-    if (!hasMoved(gen.piece)) {
+    // check for castling. We can't castle out of check or through a spot that
+    // is attacked. Castling into check is caught like any other King move.
+    if (!hasMoved(gen.piece) && !is_square_attacked(gen.move.from, !Side)) {
         // check King's side: king e->g (col 4->6), rook h-file (col 7)
         // intermediate squares f,g (cols 5,6) must be empty
-        rook = board.get(7 + gen.row * 8);
-        empty_bishop = isEmpty(board.get(5 + gen.row * 8));
-        empty_knight = isEmpty(board.get(6 + gen.row * 8));
+        rook = engine->board.get(7 + gen.row * 8);
+        empty_bishop = isEmpty(engine->board.get(5 + gen.row * 8));
+        empty_knight = isEmpty(engine->board.get(6 + gen.row * 8));
         if (!isEmpty(rook) && !hasMoved(rook)) {
-            if (empty_bishop && empty_knight) {
+            if (empty_bishop && empty_knight && !is_square_attacked(5 + gen.row * 8, !Side)) {
                 // We can castle on the King's side
                 gen.move.to = 6 + gen.row * 8;
-                gen.callme(gen);
-                count++;
+                count += visit<Side, Visit>(gen);
             }
         }
 
         // check Queen's side: king e->c (col 4->2), rook a-file (col 0)
         // intermediate squares b,c,d (cols 1,2,3) must be empty
-        rook = board.get(0 + gen.row * 8);
+        rook = engine->board.get(0 + gen.row * 8);
         if (!isEmpty(rook) && !hasMoved(rook)) {
-            empty_knight = isEmpty(board.get(1 + gen.row * 8));
-            empty_bishop = isEmpty(board.get(2 + gen.row * 8));
-            empty_queen  = isEmpty(board.get(3 + gen.row * 8));
-            if (empty_knight && empty_bishop && empty_queen) {
+            empty_knight = isEmpty(engine->board.get(1 + gen.row * 8));
+            empty_bishop = isEmpty(engine->board.get(2 + gen.row * 8));
+            empty_queen  = isEmpty(engine->board.get(3 + gen.row * 8));
+            if (empty_knight && empty_bishop && empty_queen && !is_square_attacked(3 + gen.row * 8, !Side)) {
                 // We can castle on the Queen's side
                 gen.move.to = 2 + gen.row * 8;
-                gen.callme(gen);
-                count++;
+                count += visit<Side, Visit>(gen);
             }
         }
     }
@@ -295,7 +662,8 @@ index_t add_king_moves(piece_gen_t &gen) {
 } // add_king_moves(piece_gen_t &gen)
 
 
-index_t add_queen_moves(piece_gen_t &gen) {
+template <Color Side, generator_t *Visit>
+static index_t add_queen_moves(piece_gen_t &gen) {
     // Stack Management
     // DECLARE ALL LOCAL VARIABLES USED IN THIS CONTEXT HERE AND
     // DO NOT MODIFY ANYTHING BEFORE CHECKING THE AVAILABLE STACK
@@ -305,6 +673,67 @@ index_t add_queen_moves(piece_gen_t &gen) {
 
     // Now we can alter local variables! 😎 
 
-    return add_rook_moves(gen) + add_bishop_moves(gen);
+    #ifdef ENA_MAGIC
+    return visit_mask<Side, Visit>(gen, magic.queen(gen.move.from, engine->board.occupied()) & ~engine->board.side(Side));
+    #else
+    return add_rook_moves<Side, Visit>(gen) + add_bishop_moves<Side, Visit>(gen);
+    #endif
 
 } // add_queen_moves(piece_gen_t &gen)
+
+
+
+
+// Generate the moves for a piece of one side
+template <Color Side, generator_t *Visit>
+static index_t add_side_moves(piece_gen_t &gen) {
+    switch (gen.type) {
+        default: printf(Always, "bad type: line %d\n", __LINE__);   break;
+        case   Pawn:    return add_pawn_moves<Side, Visit>(gen);
+        case Knight:    return add_knight_moves<Side, Visit>(gen);
+        case Bishop:    return add_bishop_moves<Side, Visit>(gen);
+        case   Rook:    return add_rook_moves<Side, Visit>(gen);
+        case  Queen:    return add_queen_moves<Side, Visit>(gen);
+        case   King:    return add_king_moves<Side, Visit>(gen);
+    }
+
+    return 0;
+
+} // add_side_moves(piece_gen_t &gen)
+
+
+// Generate the moves for a piece of either side
+template <generator_t *Visit>
+static index_t add_visit_moves(piece_gen_t &gen) {
+    return gen.whites_turn ? add_side_moves<White, Visit>(gen) : add_side_moves<Black, Visit>(gen);
+
+} // add_visit_moves(piece_gen_t &gen)
+
+
+// The visitor used for any gen.callme that doesn't have its own move generators
+static void call_callme(piece_gen_t &gen) {
+    gen.callme(gen);
+
+} // call_callme(piece_gen_t &gen)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Generate the moves for the piece set up in a piece_gen_t. The visitors that the
+// search uses for every node have their own copies of the move generators. On AVR
+// only the ones used by the default options do, to save flash.
+//
+// returns the number of moves generated
+index_t add_piece_moves(piece_gen_t &gen) {
+    if (collect_moves == gen.callme) { return add_visit_moves<collect_moves>(gen); }
+    if (visit_quiet == gen.callme) { return add_visit_moves<visit_quiet>(gen); }
+    if (collect_captures == gen.callme) { return add_visit_moves<collect_captures>(gen); }
+
+    #if !defined(__AVR__)
+    if (list_move == gen.callme) { return add_visit_moves<list_move>(gen); }
+    if (consider_negamax == gen.callme) { return add_visit_moves<consider_negamax>(gen); }
+    if (consider_move == gen.callme) { return add_visit_moves<consider_move>(gen); }
+    #endif
+
+    return add_visit_moves<call_callme>(gen);
+
+} // add_piece_moves(piece_gen_t &gen)
@@ -0,0 +1,141 @@
+/**
+ * pv.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess principal variation table implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "pv.h"
+
+pv_t::pv_t()
+{
+    init();
+
+} // pv_t::pv_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the index of the first move in the line for a ply
+int pv_t::offset(index_t const ply)
+{
+    return ply * PV_PLIES - (ply * (ply - 1)) / 2;
+
+} // pv_t::offset(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Empty all of the lines and the last principal variation
+void pv_t::init()
+{
+    memset(lengths, 0, sizeof(lengths));
+    last_length = 0;
+    follow = False;
+
+} // pv_t::init()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Empty the line for a ply
+void pv_t::clear(index_t const ply)
+{
+    if (ply < PV_PLIES) {
+        lengths[ply] = 0;
+    }
+
+} // pv_t::clear(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set the line for a ply to a move followed by the line for the next ply
+void pv_t::update(index_t const ply, move_t const &move)
+{
+    if (ply >= PV_PLIES) {
+        return;
+    }
+
+    pv_move_t * const line = &lines[offset(ply)];
+
+    line[0] = { uint8_t(move.from), uint8_t(move.to) };
+    lengths[ply] = 1;
+
+    if (ply + 1 < PV_PLIES) {
+        pv_move_t const * const next = &lines[offset(ply + 1)];
+        for (index_t i = 0; i < lengths[ply + 1]; i++) {
+            line[lengths[ply]++] = next[i];
+        }
+    }
+
+} // pv_t::update(index_t const ply, move_t const &move)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set the line for a ply to the line for the same ply in another table
+void pv_t::copy(index_t const ply, pv_t const &other)
+{
+    if (ply >= PV_PLIES) {
+        return;
+    }
+
+    lengths[ply] = other.lengths[ply];
+    memmove(&lines[offset(ply)], &other.lines[offset(ply)], sizeof(pv_move_t) * lengths[ply]);
+
+} // pv_t::copy(index_t const ply, pv_t const &other)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Keep the line for ply 0 as the last principal variation
+void pv_t::save()
+{
+    last_length = lengths[0];
+    memmove(last, lines, sizeof(pv_move_t) * last_length);
+
+} // pv_t::save()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// See if a move is the move at a ply in the last principal variation
+Bool pv_t::is_last(index_t const ply, move_t const &move) const
+{
+    return (ply < last_length) && (last[ply].from == move.from) && (last[ply].to == move.to);
+
+} // pv_t::is_last(index_t const ply, move_t const &move)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the spot the move at a ply in the last principal variation starts from
+//
+// returns the board index or -1 if the last principal variation isn't that long
+index_t pv_t::last_from(index_t const ply) const
+{
+    return (ply < last_length) ? index_t(last[ply].from) : index_t(-1);
+
+} // pv_t::last_from(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the spot the move at a ply in the last principal variation ends at
+//
+// returns the board index or -1 if the last principal variation isn't that long
+index_t pv_t::last_to(index_t const ply) const
+{
+    return (ply < last_length) ? index_t(last[ply].to) : index_t(-1);
+
+} // pv_t::last_to(index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Display the last principal variation
+void pv_t::show() const
+{
+    printf(Debug1, "PV:");
+
+    for (index_t i = 0; i < last_length; i++) {
+        printf(Debug1, " %c%c-%c%c",
+            (last[i].from % 8) + 'A', '8' - (last[i].from / 8),
+            (last[i].to   % 8) + 'A', '8' - (last[i].to   / 8));
+    }
+
+} // pv_t::show()
@@ -0,0 +1,78 @@
+/**
+ * pv.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The pv_t triangular table used to collect the principal variation:
+ * the line of moves the search expects both sides to play.
+ *
+ */
+#ifndef PV_INCL
+#define PV_INCL
+
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// a move in a principal variation
+struct pv_move_t {
+    uint8_t from : 6,
+              to : 6;
+
+};  // pv_move_t
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the principal variation table
+//
+// The line for each ply is the best move at that ply followed by the line
+// for the ply below it, so the line for ply N only needs PV_PLIES - N moves.
+// The lines are packed one after the other to form a triangle.
+class pv_t {
+    private:
+    pv_move_t           lines[PV_PLIES * (PV_PLIES + 1) / 2];
+    index_t             lengths[PV_PLIES];
+
+    // The principal variation from the last search that finished
+    pv_move_t           last[PV_PLIES];
+    index_t             last_length;
+
+    // Get the index of the first move in the line for a ply
+    static int offset(index_t const ply);
+
+    public:
+    // True while the moves being searched are the moves in the last
+    // principal variation so that they can be searched first
+    Bool                follow;
+
+    pv_t();
+
+    // Empty all of the lines and the last principal variation
+    void init();
+
+    // Empty the line for a ply
+    void clear(index_t const ply);
+
+    // Set the line for a ply to a move followed by the line for the next ply
+    void update(index_t const ply, move_t const &move);
+
+    // Set the line for a ply to the line for the same ply in another table
+    void copy(index_t const ply, pv_t const &other);
+
+    // Keep the line for ply 0 as the last principal variation
+    void save();
+
+    // See if a move is the move at a ply in the last principal variation
+    Bool is_last(index_t const ply, move_t const &move) const;
+
+    // Get the spot the move at a ply in the last principal variation starts from or -1
+    index_t last_from(index_t const ply) const;
+
+    // Get the spot the move at a ply in the last principal variation ends at or -1
+    index_t last_to(index_t const ply) const;
+
+    // Display the last principal variation
+    void show() const;
+
+};  // pv_t
+
+#endif // PV_INCL
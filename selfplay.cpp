@@ -0,0 +1,196 @@
+/**
+ * selfplay.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess self-play runner implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "selfplay.h"
+
+#ifdef ENA_SELFPLAY
+
+#include <memory>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Play game.options.selfplay_games games using game.options.selfplay_threads threads.
+//
+// Every game is played with the options from the calling thread's engine except
+// that nothing is shown while they play, and game number N is seeded with the
+// options seed plus N so that any of the games can be played again. The calling
+// thread shows the totals each time a game finishes until they are all done.
+//
+// Each thread searches with its own transposition table, which is emptied before
+// every game, so the games don't depend on each other or on which thread plays them.
+void selfplay_t::run()
+{
+    index_t const threads = max(1L, min((long) engine->game.options.selfplay_threads, (long) MAX_THREADS));
+    std::thread workers[MAX_THREADS];
+    uint32_t const start = millis();
+    uint32_t shown = 0;
+    char str[16] = "";
+
+    options = engine->game.options;
+    options.print_level = None;
+    options.live_update = False;
+    options.white_human = False;
+    options.black_human = False;
+    options.continuous = False;
+    options.benchmark = False;
+
+    // The smp_t searches are for one game at a time
+    #ifdef ENA_SMP
+    options.threads = 1;
+    options.root_split = False;
+    #endif
+
+    game_count = engine->game.options.selfplay_games;
+    started = 0;
+
+    results.init();
+    games = 0;
+    moves = 0;
+    nodes = 0;
+    duration = 0;
+
+    ftostr(game_count, 0, str);
+    printf(Debug1, "Playing %s self-play games on %d thread%s\n\n", str, threads, (1 == threads) ? "" : "s");
+
+    for (index_t id = 0; id < threads; id++) {
+        workers[id] = std::thread(&selfplay_t::play_games, this, id);
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        while (shown < game_count) {
+            finished.wait(guard, [this, shown] { return games > shown; });
+            shown = games;
+            show_totals(millis() - start);
+        }
+    }
+
+    for (index_t id = 0; id < threads; id++) {
+        workers[id].join();
+    }
+
+} // selfplay_t::run()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Play games on one thread until they have all been taken
+void selfplay_t::play_games(index_t const id)
+{
+    engine_t &player = engines[id];
+    std::unique_ptr<ttable_t> const table(new ttable_t());
+    uint32_t index;
+
+    while (next_game(index)) {
+        // Make this thread play with its own engine, table and seed
+        player.init();
+        player.player = True;
+        player.table = table.get();
+        player.tt().clear();
+        player.game.options = options;
+        player.game.options.seed = options.seed + index;
+        player.seed(player.game.options.seed);
+
+        #ifdef ENA_MATCH
+        if (options.match) {
+            match.setup_game(player.game.options, index);
+        }
+        #endif
+
+        if (player.game.options.shuffle_pieces) {
+            player.game.sort_pieces(player.game.turn);
+            player.game.shuffle_pieces(SHUFFLE);
+        }
+
+        player.game.stats.start_game_stats();
+
+        do {
+            take_turn();
+        } while (PLAYING == player.game.state);
+
+        player.game.stats.stop_game_stats();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            results.add(state_t(player.game.state));
+            games++;
+            moves += player.game.move_num;
+            nodes += player.game.stats.game_stats.counter();
+            duration += player.game.stats.game_stats.duration();
+
+            #ifdef ENA_MATCH
+            // The games already started are still counted when the match is decided
+            if (options.match) {
+                match.add(state_t(player.game.state), index);
+                if (0 != match.result()) {
+                    game_count = started;
+                }
+            }
+            #endif
+        }
+
+        finished.notify_one();
+    }
+
+} // selfplay_t::play_games(index_t const id)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Take the next game to play
+//
+// returns False if there are no more games to play
+Bool selfplay_t::next_game(uint32_t &index)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (started >= game_count) {
+        return False;
+    }
+
+    index = started++;
+    return True;
+
+} // selfplay_t::next_game(uint32_t &index)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Show the totals for the games that have finished so far. The moves evaluated
+// per second and the time for each move are the averages for the games, while
+// the games per hour are for all of the threads together.
+void selfplay_t::show_totals(uint32_t const elapsed) const
+{
+    char str[16] = "";
+
+    results.show();
+
+    #ifdef ENA_MATCH
+    if (options.match) {
+        match.show();
+    }
+    #endif
+
+    ftostr(games, 0, str);
+    printf(Debug1, "   Games: %s of ", str);
+    ftostr(game_count, 0, str);
+    printf(Debug1, "%s  ", str);
+
+    ftostr((0 == elapsed) ? 0.0 : (double(games) * 3600000.0 / elapsed), 0, str);
+    printf(Debug1, "Games per hour: %s  ", str);
+
+    ftostr((0 == duration) ? 0.0 : (double(nodes) * 1000.0 / duration), 0, str);
+    printf(Debug1, "Moves evaluated per second: %s  ", str);
+
+    ftostr((0 == moves) ? 0.0 : (double(duration) / moves), 1, str);
+    printf(Debug1, "ms per move: %s\n\n", str);
+
+} // selfplay_t::show_totals(uint32_t const elapsed)
+
+#endif // ENA_SELFPLAY
@@ -0,0 +1,80 @@
+/**
+ * selfplay.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The selfplay_t runner that plays many games against itself at the same
+ * time. Each thread plays one game after another with its own engine_t
+ * and transposition table, and each game gets its own seed for the
+ * pseudo-random numbers. The way the games ended is added up in the same
+ * table as the continuous games, along with the games played per hour,
+ * the moves evaluated per second and the time taken for each move. With
+ * game.options.match the games are the games of the match_t and they
+ * stop as soon as it is decided.
+ *
+ */
+#ifndef SELFPLAY_INCL
+#define SELFPLAY_INCL
+
+#ifdef ENA_SELFPLAY
+
+#include <stdint.h>
+
+// The printf(...) macro is put aside while these are included because they can
+// include <cstdio>, which takes printf back
+#pragma push_macro("printf")
+#undef printf
+#include <condition_variable>
+#include <mutex>
+#pragma pop_macro("printf")
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the self-play games played on more than one thread
+class selfplay_t {
+    private:
+    // The engines that play the games, one for each thread
+    engine_t            engines[MAX_THREADS];
+
+    // The options every game is played with
+    options_t           options;
+
+    // The lock guards everything below it. The main thread is told each
+    // time a game finishes.
+    std::mutex          lock;
+
+    // The number of games started and the number of games to play
+    uint32_t            started;
+    uint32_t            game_count;
+
+    // The totals for the games that have finished
+    std::condition_variable finished;
+    results_t           results;
+    uint32_t            games;
+    uint32_t            moves;
+    uint64_t            nodes;
+    uint64_t            duration;
+
+    // Play games on one thread until they have all been taken
+    void play_games(index_t const id);
+
+    // Take the next game to play
+    //
+    // returns False if there are no more games to play
+    Bool next_game(uint32_t &index);
+
+    // Show the totals for the games that have finished so far
+    void show_totals(uint32_t const elapsed) const;
+
+    public:
+
+    // Play game.options.selfplay_games games using game.options.selfplay_threads
+    // threads with the rest of the options from the calling thread's engine
+    void run();
+
+};  // selfplay_t
+
+extern selfplay_t selfplay;
+
+#endif // ENA_SELFPLAY
+
+#endif // SELFPLAY_INCL
@@ -0,0 +1,353 @@
+/**
+ * smp.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess Lazy SMP and root split search implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "smp.h"
+
+#ifdef ENA_SMP
+
+#include <thread>
+
+smp_t::smp_t() : stopping(False)
+{
+    init();
+
+} // smp_t::smp_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Clear the count of the moves evaluated by the helper threads
+void smp_t::init()
+{
+    helper_moves = 0;
+
+} // smp_t::init()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Set up the engine for a thread as a copy of another engine. The threads
+// don't print or update the LEDs and never read the serial port.
+//
+// returns the engine for the thread
+engine_t &smp_t::copy_engine(index_t const id, engine_t const &from)
+{
+    engine_t &copy = engines[id];
+
+    copy.board = from.board;
+    copy.game = from.game;
+    copy.pv = from.pv;
+    copy.heuristics = from.heuristics;
+    copy.table = from.table;
+    copy.helper = True;
+
+    copy.game.options.print_level = None;
+    copy.game.options.live_update = False;
+
+    return copy;
+
+} // smp_t::copy_engine(index_t const id, engine_t const &from)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Search the position for one of the Lazy SMP helper threads. The helper shuffles
+// its pieces so that the moves with the same scores are searched in another order.
+static void search_helper(engine_t * const helper)
+{
+    move_t wmove = { -1, -1, MIN_VALUE };
+    move_t bmove = { -1, -1, MAX_VALUE };
+
+    engine = helper;
+
+    engine->game.sort_pieces(engine->game.turn);
+    engine->game.shuffle_pieces(SHUFFLE);
+
+    search_moves(wmove, bmove);
+
+} // search_helper(engine_t * const helper)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Choose the best moves for both sides using game.options.threads threads.
+//
+// With Lazy SMP each helper thread searches a copy of the main thread's engine
+// and every other one searches a ply deeper. The main thread's moves are the ones
+// used, and the helpers are stopped as soon as the main thread has them. With the
+// root split the threads are used by split(...) instead.
+void smp_t::search(move_t &wmove, move_t &bmove)
+{
+    index_t const threads = min((long) engine->game.options.threads, (long) MAX_THREADS);
+
+    // A book or user move only has to be checked so one thread is enough
+    if ((threads < 2) || engine->game.book_supplied || engine->game.user_supplied || engine->game.options.root_split) {
+        search_moves(wmove, bmove);
+        return;
+    }
+
+    engine_t * const main_engine = engine;
+    std::thread workers[MAX_THREADS - 1];
+
+    stopping = False;
+
+    for (index_t id = 1; id < threads; id++) {
+        engine_t &helper = copy_engine(id, *main_engine);
+
+        if (id & 1) {
+            helper.game.options.maxply = min((long) helper.game.options.maxply + 1, (long) helper.game.options.max_max_ply);
+        }
+
+        workers[id - 1] = std::thread(search_helper, &helper);
+    }
+
+    search_moves(wmove, bmove);
+
+    stopping = True;
+
+    for (index_t id = 1; id < threads; id++) {
+        workers[id - 1].join();
+        helper_moves += engines[id].game.stats.move_stats.counter();
+    }
+
+} // smp_t::search(move_t &wmove, move_t &bmove)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Choose the best move at the root by sharing the root moves out between the threads.
+//
+// The root moves are generated and ordered the same way choose_best_moves(...) does,
+// and then each thread takes the next move that hasn't been searched yet until they
+// have all been taken. The best value found so far is shared between the threads so
+// that the moves searched after it can be pruned. The threads never pick a move
+// between themselves: the best value wins, and the move that was ordered first wins
+// between equal values, so the move chosen doesn't depend on which thread searched it.
+//
+// returns False if the root can't be split and the moves weren't searched
+Bool smp_t::split(move_t &wbest, move_t &bbest)
+{
+    index_t const threads = min((long) engine->game.options.threads, (long) MAX_THREADS);
+    engine_t * const main_engine = engine;
+    move_t &best = engine->game.turn ? wbest : bbest;
+    std::thread workers[MAX_THREADS - 1];
+    stack_move_t const *listed;
+    tt_entry_t const *entry;
+    order_t order;
+    legal_t legal;
+    index_t index;
+    index_t winner;
+
+    // Each thread searches with negamax and generates only the legal moves
+    if ((threads < 2) || !engine->game.options.root_split || !engine->game.options.negamax ||
+        !engine->game.options.legal_moves || engine->helper || (0 != engine->game.ply) ||
+        engine->game.book_supplied || engine->game.user_supplied) {
+        return False;
+    }
+
+    uint32_t const before = engine->game.stats.move_stats.counter();
+    move_t move = { -1, -1, 0 };
+    piece_gen_t gen(move, wbest, bbest, list_move, True);
+
+    best = { -1, -1, MIN_VALUE };
+    engine->pv.clear(0);
+
+    find_checks_and_pins(legal, engine->game.turn);
+    gen.legal = &legal;
+
+    // The best move from the transposition table or the last principal
+    // variation is put first like it is in choose_best_moves(...)
+    order.callback = consider_negamax;
+    order.count = 0;
+    order.best_from = -1;
+    order.best_to = -1;
+    order.best_found = False;
+
+    if (engine->game.options.trans_table) {
+        entry = engine->tt().probe(engine->game.hash);
+        if ((nullptr != entry) && (entry->from != entry->to)) {
+            order.best_from = entry->from;
+            order.best_to = entry->to;
+        }
+    }
+
+    if (engine->pv.follow && (-1 != engine->pv.last_from(0))) {
+        order.best_from = engine->pv.last_from(0);
+        order.best_to = engine->pv.last_to(0);
+    }
+
+    gen.order = &order;
+
+    // Generate the root moves onto the move stack and take them back off in order
+    engine->move_stack.begin(0);
+    for (index = 0; index < engine->game.piece_count; index++) {
+        if (set_gen_piece(gen, index)) {
+            add_piece_moves(gen);
+        }
+    }
+
+    root_count = 0;
+    while ((root_count < MAX_ROOT_MOVES) && (nullptr != (listed = engine->move_stack.next(0)))) {
+        roots[root_count++] = listed->move;
+    }
+
+    // With no legal moves it is checkmate when the King is in check and stalemate when it isn't
+    if (0 == root_count) {
+        if (0 != legal.checkers) {
+            best.value = MIN_VALUE;
+            engine->game.state = engine->game.turn ? BLACK_CHECKMATE : WHITE_CHECKMATE;
+        }
+        else {
+            best.value = 0;
+            engine->game.state = STALEMATE;
+        }
+    }
+    else {
+        root = main_engine;
+        next_root = 0;
+        root_alpha = MIN_VALUE;
+
+        for (index = 0; index < threads; index++) {
+            copy_engine(index, *main_engine);
+            bests[index] = { -1, -1, MIN_VALUE };
+            best_index[index] = MAX_ROOT_MOVES;
+        }
+
+        for (index = 1; index < threads; index++) {
+            workers[index - 1] = std::thread(&smp_t::search_roots, this, index);
+        }
+
+        search_roots(0);
+        engine = main_engine;
+
+        winner = -1;
+        for (index = 0; index < threads; index++) {
+            if (index > 0) {
+                workers[index - 1].join();
+            }
+
+            engine_t const &worker = engines[index];
+            uint32_t const moves = worker.game.stats.move_stats.counter() - before;
+
+            engine->game.stats.add_moves_count(moves);
+            engine->game.stats.move_stats.depth = max(engine->game.stats.move_stats.depth, worker.game.stats.move_stats.depth);
+            engine->game.timeout1 |= worker.game.timeout1;
+            engine->game.timeout2 |= worker.game.timeout2;
+
+            if ((MAX_ROOT_MOVES != best_index[index]) && ((-1 == winner) ||
+                (bests[index].value > bests[winner].value) ||
+                ((bests[index].value == bests[winner].value) && (best_index[index] < best_index[winner])))) {
+                winner = index;
+            }
+        }
+
+        if (-1 != winner) {
+            best = bests[winner];
+            engine->pv.copy(0, lines[winner]);
+        }
+    }
+
+    if (2 == engine->game.piece_count) {
+        engine->game.state = STALEMATE;
+    }
+
+    // Give the caller the value from White's point of view like choose_best_moves(...)
+    if (!engine->game.turn) {
+        best.value = -best.value;
+    }
+
+    return True;
+
+} // smp_t::split(move_t &wbest, move_t &bbest)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Search one of the root moves for a thread with the given window. The search
+// starts from the root's principal variation.
+//
+// returns the move with its value, or from == -1 if it wasn't searched
+move_t smp_t::search_move(index_t const id, legal_t const &legal, int const index, long const alpha, long const beta)
+{
+    engine_t &worker = engines[id];
+    move_t move = { -1, -1, 0 };
+    move_t wbest = { -1, -1, MIN_VALUE };
+    move_t bbest = { -1, -1, MIN_VALUE };
+    piece_gen_t gen(move, wbest, bbest, consider_negamax, True);
+
+    worker.pv = root->pv;
+    worker.pv.clear(0);
+
+    set_gen_piece(gen, worker.game.find_piece(roots[index].from));
+    gen.move.to = roots[index].to;
+    gen.alpha = alpha;
+    gen.beta = beta;
+    gen.legal = &legal;
+    gen.follow_pv = worker.pv.follow;
+    (gen.whites_turn ? gen.num_wmoves : gen.num_bmoves) = root_count;
+
+    consider_negamax(gen);
+
+    return worker.game.turn ? wbest : bbest;
+
+} // smp_t::search_move(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Search the root moves for one thread until they have all been taken.
+//
+// The first move is searched with the full window. The moves after it are searched
+// with a null window just below the best value found so far, which can only prove
+// that they are no better, and then again with the full window when they might be
+// like principal variation search does in choose_best_moves(...). The window is one
+// below the best value so that the moves that are just as good still get their values.
+void smp_t::search_roots(index_t const id)
+{
+    engine_t &worker = engines[id];
+    legal_t legal;
+    move_t best;
+    long window;
+    long seen;
+    int index;
+
+    engine = &worker;
+
+    find_checks_and_pins(legal, worker.game.turn);
+
+    while (!worker.game.timeout1 && ((index = next_root++) < root_count)) {
+        // Every root move starts from the same killer moves and history counts
+        // so its value doesn't depend on the thread searching it
+        worker.heuristics = root->heuristics;
+
+        seen = root_alpha.load();
+        window = (MIN_VALUE == seen) ? MIN_VALUE : (seen - 1);
+
+        if (MIN_VALUE == seen) {
+            best = search_move(id, legal, index, window, MAX_VALUE);
+        }
+        else {
+            best = search_move(id, legal, index, window, seen);
+            if ((-1 != best.from) && (best.value > window) && !worker.game.timeout1) {
+                best = search_move(id, legal, index, window, MAX_VALUE);
+            }
+        }
+
+        // A value at or below the window only says the move is no better
+        // than a move that has already been found
+        if ((-1 == best.from) || (best.value <= window)) {
+            continue;
+        }
+
+        while ((best.value > seen) && !root_alpha.compare_exchange_weak(seen, best.value)) {}
+
+        if ((best.value > bests[id].value) || ((best.value == bests[id].value) && (index < best_index[id]))) {
+            bests[id] = best;
+            best_index[id] = index;
+            lines[id].copy(0, worker.pv);
+        }
+    }
+
+} // smp_t::search_roots(index_t const id)
+
+#endif // ENA_SMP
@@ -0,0 +1,102 @@
+/**
+ * smp.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The smp_t searches that use more than one thread for each move.
+ *
+ * With Lazy SMP the helper threads each search the same position with
+ * their own engine_t at the same time as the main thread, sharing what
+ * they find through the transposition table. The helpers start with their
+ * pieces in a different order and every other one searches a ply deeper
+ * so that they don't all search the same moves. Only the main thread's
+ * moves are used.
+ *
+ * With the root split the moves at the root are shared out between the
+ * threads instead. Each thread takes the next root move that hasn't been
+ * searched yet and searches it with its own engine_t, and the best value
+ * found so far is shared so that the moves searched later only need a null
+ * window to prove they are no better. Only the last depth of iterative
+ * deepening is split so its moves are ordered the same as with one thread.
+ *
+ */
+#ifndef SMP_INCL
+#define SMP_INCL
+
+#ifdef ENA_SMP
+
+#include <atomic>
+#include <stdint.h>
+
+// The most moves there can be at the root
+enum { MAX_ROOT_MOVES = 256 };
+
+// The checks and pins of the side to move, declared in MicroChess.h
+struct legal_t;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the searches that use more than one thread
+class smp_t {
+    private:
+    // The engines for the threads. The Lazy SMP helpers use all but the first one
+    // and the root split uses one for each thread.
+    engine_t            engines[MAX_THREADS];
+
+    // Set when the main thread has its moves so the helpers stop searching
+    std::atomic<Bool>   stopping;
+
+    // The engine the root moves are from, the root moves being split between
+    // the threads, the next one to be searched, and the best value found for
+    // any of them so far
+    engine_t const *    root;
+    pmove_t             roots[MAX_ROOT_MOVES];
+    int                 root_count;
+    std::atomic<int>    next_root;
+    std::atomic<long>   root_alpha;
+
+    // The best root move found by each thread, the index of the move in roots[],
+    // and the line that follows it
+    move_t              bests[MAX_THREADS];
+    int                 best_index[MAX_THREADS];
+    pv_t                lines[MAX_THREADS];
+
+    // The moves evaluated by the Lazy SMP helper threads since init(). The root
+    // split adds the moves its threads evaluate to the main thread's statistics.
+    uint32_t            helper_moves;
+
+    // Set up the engine for a thread as a copy of another engine
+    engine_t &copy_engine(index_t const id, engine_t const &from);
+
+    // Search one of the root moves for a thread with the given window
+    move_t search_move(index_t const id, legal_t const &legal, int const index, long const alpha, long const beta);
+
+    // Search the root moves for one thread until they have all been taken
+    void search_roots(index_t const id);
+
+    public:
+    smp_t();
+
+    // Clear the count of the moves evaluated by the helper threads
+    void init();
+
+    // Choose the best moves for both sides using game.options.threads threads
+    void search(move_t &wmove, move_t &bmove);
+
+    // Choose the best move at the root by splitting the root moves between the threads
+    //
+    // returns False if the root can't be split and the moves weren't searched
+    Bool split(move_t &wbest, move_t &bbest);
+
+    // See if the helper threads should stop searching
+    Bool stopped() const { return stopping.load(std::memory_order_relaxed); }
+
+    // Get the moves evaluated by the Lazy SMP helper threads since init()
+    uint32_t helper_count() const { return helper_moves; }
+
+};  // smp_t
+
+extern smp_t smp;
+
+#endif // ENA_SMP
+
+#endif // SMP_INCL
@@ -88,6 +88,13 @@ uint32_t movetime_t::increment()
 }
 
 
+// Add to the counter
+void movetime_t::add(uint32_t const moves)
+{
+    if (running) count += moves;
+}
+
+
 // Get the counter
 uint32_t movetime_t::counter() const 
 {
@@ -130,6 +137,13 @@ void stat_t::inc_moves_count() {
 }
 
 
+// Add the moves evaluated by another engine
+void stat_t::add_moves_count(uint32_t const moves) {
+    game_stats.add(moves);
+    move_stats.add(moves);
+}
+
+
 // Start the game timers and clear out the game counts
 void stat_t::start_game_stats() {
     game_stats.begin();
@@ -157,4 +171,75 @@ uint32_t stat_t::move_count_so_far() const {
 // Stop the move timers and calc the move stats
 void stat_t::stop_move_stats() {
     move_stats.end();
-}
\ No newline at end of file
+}
+
+
+/*
+ ******************************************************************************************
+ * results_t objects
+ * 
+ */
+
+
+// Constructor:
+results_t::results_t() {
+    init();
+}
+
+
+// Init method
+void results_t::init() {
+    memset(state_totals, 0, sizeof(state_totals));
+    white_wins = 0;
+    black_wins = 0;
+}
+
+
+// Count a game that ended with the given state
+void results_t::add(state_t const state) {
+    state_totals[state - 1]++;
+
+    switch (state) {
+        default:
+        case PLAYING:
+        case STALEMATE:
+        case MOVE_LIMIT:
+            break;
+
+        case WHITE_CHECKMATE:
+        case BLACK_3_MOVE_REP:
+            white_wins++;
+            break;
+
+        case BLACK_CHECKMATE:
+        case WHITE_3_MOVE_REP:
+            black_wins++;
+            break;
+    }
+}
+
+
+// Show the table of the game end reasons and the wins for each side
+void results_t::show() const {
+    char str[16] = "";
+
+    printf(Debug1, "         Stalemate   White Checkmate   Black Checkmate  White %d-Move Rep  Black %d-Move Rep        Move Limit\n", 
+        MAX_REPS, MAX_REPS);
+    
+    ftostr(state_totals[       STALEMATE - 1], 0, str);
+    printf(Debug1, "%18s", str);
+    ftostr(state_totals[ WHITE_CHECKMATE - 1], 0, str);
+    printf(Debug1, "%18s", str);
+    ftostr(state_totals[ BLACK_CHECKMATE - 1], 0, str);
+    printf(Debug1, "%18s", str);
+    ftostr(state_totals[WHITE_3_MOVE_REP - 1], 0, str);
+    printf(Debug1, "%18s", str);
+    ftostr(state_totals[BLACK_3_MOVE_REP - 1], 0, str);
+    printf(Debug1, "%18s", str);
+    ftostr(state_totals[     MOVE_LIMIT - 1], 0, str);
+    printf(Debug1, "%18s", str);
+
+    printnl(Debug1);
+
+    printf(Debug1, "   White wins: %3ld   Black wins: %3ld\n\n", white_wins, black_wins);
+}
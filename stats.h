@@ -51,6 +51,9 @@ public:
     // Increment the counter
     uint32_t increment();
 
+    // Add to the counter
+    void add(uint32_t const moves);
+
     // Get the counter
     uint32_t counter() const;
 
@@ -75,6 +78,9 @@ struct stat_t {
     // increase the number of moves evaluated
     void inc_moves_count();
 
+    // add the moves evaluated by another engine
+    void add_moves_count(uint32_t const moves);
+
     // start the game timers and clear out the game counts
     void start_game_stats();
 
@@ -91,4 +97,26 @@ struct stat_t {
 
 };  // stat_t
 
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the number of games that ended each way and the wins for each side
+struct results_t {
+    uint32_t    state_totals[6];
+    uint32_t    white_wins;
+    uint32_t    black_wins;
+
+    // constructor:
+    results_t();
+
+    // init method
+    void init();
+
+    // count a game that ended with the given state
+    void add(state_t const state);
+
+    // show the table of the game end reasons and the wins for each side
+    void show() const;
+
+};  // results_t
+
 #endif  // STATS_INCL
\ No newline at end of file
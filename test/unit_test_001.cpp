@@ -35,10 +35,116 @@
 #include "Arduino.h"
 #include "MicroChess.h"
 
+//  the sketch holds the search and make(...) / unmake(...) used by perft(...)
+#include "../MicroChess.ino"
+
+
+//  Set up a position from the first four fields of a FEN string.
+//  The castling rights are kept by leaving the King and the Rooks unmoved,
+//  and an en-passant square by making the last move the pawn's double step.
+void set_position(char const *fen)
+{
+  Piece piece;
+  index_t col = 0;
+  index_t row = 0;
+
+  engine->board.clear();
+
+  for ( ; ' ' != *fen; fen++)
+  {
+    if ('/' == *fen) { col = 0; row++; continue; }
+    if (isdigit(*fen)) { col += *fen - '0'; continue; }
+
+    switch (tolower(*fen))
+    {
+      case 'p': piece = Pawn;   break;
+      case 'n': piece = Knight; break;
+      case 'b': piece = Bishop; break;
+      case 'r': piece = Rook;   break;
+      case 'q': piece = Queen;  break;
+      default:  piece = King;   break;
+    }
+    Color const side = isupper(*fen) ? White : Black;
+    Bool const moved = (King == piece) || (Rook == piece) ||
+      ((Pawn == piece) && (row != ((White == side) ? 6 : 1)));
+    engine->board.set(col++ + row * 8, makeSpot(piece, side, moved, False));
+  }
+
+  Color const turn = ('w' == *++fen) ? White : Black;
+  fen += 2;
+
+  for ( ; ' ' != *fen; fen++)
+  {
+    index_t const back = isupper(*fen) ? 7 : 0;
+    index_t const rook = ('k' == tolower(*fen)) ? 7 : 0;
+    if ('-' == *fen) continue;
+    engine->board.set(4 + back * 8, setMoved(engine->board.get(4 + back * 8), False));
+    engine->board.set(rook + back * 8, setMoved(engine->board.get(rook + back * 8), False));
+  }
+
+  engine->game.init();
+  engine->game.last_move = { -1, -1, 0 };
+  if ('-' != *++fen)
+  {
+    index_t const ep_col = fen[0] - 'a';
+    index_t const from_row = (White == turn) ? 1 : 6;
+    index_t const to_row = (White == turn) ? 3 : 4;
+    engine->game.last_move = { index_t(ep_col + from_row * 8), index_t(ep_col + to_row * 8), 0 };
+  }
+
+  for (index_t spot = 0; spot < index_t(BOARD_SIZE); spot++)
+  {
+    if (King != getType(engine->board.get(spot))) continue;
+    ((White == getSide(engine->board.get(spot))) ? engine->game.wking : engine->game.bking) = spot;
+  }
+
+  engine->game.turn = turn;
+  engine->game.hash = hash_board(turn);
+  engine->game.calc_eval(engine->board, engine->game.eval);
+  check_kings();
+}
+
+
+//  The number of positions at each depth, the same for the legal and the
+//  pseudo-legal move generators and for the bitboard, magic and array
+//  board backends. The engine only promotes to a Queen so the depths are
+//  kept to where the published counts have no promotions.
+struct perft_test_t
+{
+  char const *fen;
+  uint32_t    counts[4];
+};
+
+static perft_test_t const perft_tests[] =
+{
+  //  the start position
+  { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -", { 20, 400, 8902, 197281 } },
+  //  castling on both sides, pins, en-passant captures ("Kiwipete")
+  { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", { 48, 2039, 97862, 0 } },
+  //  an en-passant capture that would uncover a check along the row
+  { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -", { 14, 191, 2812, 43238 } },
+  //  both sides castling on both sides
+  { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq -", { 26, 568, 13744, 0 } },
+  //  castling through the attacked f1 isn't allowed but castling on the Queen's side is
+  { "1k3r2/8/8/8/8/8/8/R3K2R w KQ -", { 23, 0, 0, 0 } },
+  //  the Bishop is pinned to the King on the column
+  { "k3r3/8/8/8/8/8/4B3/4K3 w - -", { 4, 0, 0, 0 } },
+  //  the black pawn just stepped two rows and the white pawn can take it en-passant
+  { "4k3/8/8/3pP3/8/8/8/4K3 w - d6", { 7, 0, 0, 0 } },
+};
+
 
 unittest_setup()
 {
   fprintf(stderr, "MicroChess\n");
+
+  #ifdef ENA_MAGIC
+  magic.init();
+  #endif
+
+  engine->init();
+  engine->game.options.print_level = None;
+  engine->game.options.time_limit = 0;
 }
 
 
@@ -51,6 +157,39 @@ unittest(test_mock)
 {
 }
 
+
+unittest(test_perft_counts)
+{
+  for (perft_test_t const &test : perft_tests)
+  {
+    fprintf(stderr, "%s\n", test.fen);
+    set_position(test.fen);
+    for (index_t depth = 1; depth <= 4; depth++)
+    {
+      if (0 == test.counts[depth - 1]) continue;
+      engine->game.options.legal_moves = True;
+      assertEqual(test.counts[depth - 1], perft(depth));
+    }
+  }
+}
+
+
+unittest(test_perft_legal_matches_pseudo_legal)
+{
+  for (perft_test_t const &test : perft_tests)
+  {
+    fprintf(stderr, "%s\n", test.fen);
+    set_position(test.fen);
+    for (index_t depth = 1; depth <= 3; depth++)
+    {
+      engine->game.options.legal_moves = True;
+      uint32_t const legal = perft(depth);
+      engine->game.options.legal_moves = False;
+      assertEqual(legal, perft(depth));
+    }
+  }
+}
+
 unittest_main()
 
 //  -- END OF FILE --
@@ -0,0 +1,327 @@
+/**
+ * ttable.cpp
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * MicroChess transposition table and Zobrist hashing implementation
+ *
+ */
+#include <Arduino.h>
+#include "MicroChess.h"
+#include "ttable.h"
+
+#ifdef ENA_SMP
+// The entries are shared by the Lazy SMP threads, so probe(...) gives each
+// thread its own copy of the entry it found.
+static thread_local tt_entry_t found;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Pack the value, best move, bound, depth and age of an entry into one word
+static uint64_t pack_entry(tt_entry_t const &entry)
+{
+    return uint64_t(uint32_t(entry.value)) |
+           (uint64_t(entry.from) << 32) |
+           (uint64_t(entry.to) << 38) |
+           (uint64_t(entry.bound) << 44) |
+           (uint64_t(uint8_t(entry.depth)) << 46) |
+           (uint64_t(entry.age) << 54);
+
+} // pack_entry(tt_entry_t const &entry)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Unpack a word made by pack_entry(...)
+static void unpack_entry(uint64_t const data, tt_entry_t &entry)
+{
+    entry.value = int32_t(uint32_t(data));
+    entry.from = (data >> 32) & 0x3F;
+    entry.to = (data >> 38) & 0x3F;
+    entry.bound = (data >> 44) & 0x03;
+    entry.depth = int8_t(uint8_t(data >> 46));
+    entry.age = uint8_t(data >> 54);
+
+} // unpack_entry(uint64_t const data, tt_entry_t &entry)
+#endif
+
+
+ttable_t::ttable_t()
+{
+    clear();
+
+} // ttable_t::ttable_t()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Empty the table
+void ttable_t::clear()
+{
+    #ifdef ENA_SMP
+    for (shared_t &slot : entries) {
+        slot.check.store(0, std::memory_order_relaxed);
+        slot.data.store(0, std::memory_order_relaxed);
+    }
+    #else
+    memset(entries, 0, sizeof(entries));
+    #endif
+
+} // ttable_t::clear()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Find the entry for a position.
+//
+// returns the entry or nullptr if the position is not in the table
+tt_entry_t const *ttable_t::probe(uint64_t key) const
+{
+    #ifdef ENA_MATCH
+    // The entries found with each side's options are kept apart
+    key ^= engine->game.options.tt_salt;
+    #endif
+
+    #ifdef ENA_SMP
+    shared_t const &slot = entries[key & (TT_ENTRIES - 1)];
+    uint64_t const data = slot.data.load(std::memory_order_relaxed);
+    uint64_t const check = slot.check.load(std::memory_order_relaxed);
+
+    // An empty entry or one that is being stored by another thread doesn't match
+    if ((check ^ data) != key) {
+        return nullptr;
+    }
+
+    unpack_entry(data, found);
+    found.lock = uint32_t(key >> 32);
+
+    if (NO_BOUND == found.bound) {
+        return nullptr;
+    }
+
+    return &found;
+    #else
+    tt_entry_t const &entry = entries[key & (TT_ENTRIES - 1)];
+
+    if (NO_BOUND == entry.bound || uint32_t(key >> 32) != entry.lock) {
+        return nullptr;
+    }
+
+    return &entry;
+    #endif
+
+} // ttable_t::probe(uint64_t const key)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Remember the results of searching a position. Entries from earlier turns
+// are always replaced, otherwise the deeper search wins.
+void ttable_t::store(uint64_t key, index_t const depth, bound_t const bound, long const value, move_t const &best)
+{
+    #ifdef ENA_MATCH
+    key ^= engine->game.options.tt_salt;
+    #endif
+
+    #ifdef ENA_SMP
+    // Fill in a copy of the entry and store it as two words
+    shared_t &shared = entries[key & (TT_ENTRIES - 1)];
+    tt_entry_t slot;
+    tt_entry_t entry;
+
+    unpack_entry(shared.data.load(std::memory_order_relaxed), slot);
+    #else
+    tt_entry_t &slot = entries[key & (TT_ENTRIES - 1)];
+    tt_entry_t &entry = slot;
+    #endif
+
+    if (NO_BOUND != slot.bound && engine->game.move_num == slot.age && depth < slot.depth) {
+        return;
+    }
+
+    entry.lock = uint32_t(key >> 32);
+    entry.value = value;
+    entry.bound = bound;
+    entry.depth = depth;
+    entry.age = engine->game.move_num;
+
+    if (-1 == best.from || -1 == best.to) {
+        entry.from = 0;
+        entry.to = 0;
+    }
+    else {
+        entry.from = best.from;
+        entry.to = best.to;
+    }
+
+    #ifdef ENA_SMP
+    uint64_t const data = pack_entry(entry);
+    shared.check.store(key ^ data, std::memory_order_relaxed);
+    shared.data.store(data, std::memory_order_relaxed);
+    #endif
+
+} // ttable_t::store(...)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Mate values are within this many plies of MIN_VALUE or MAX_VALUE. Those two
+// values themselves mean the position wasn't searched and are left alone.
+static long constexpr mate_plies = 64;
+
+static Bool is_mate(long const value)
+{
+    return (value > MAX_VALUE - mate_plies && value < MAX_VALUE) ||
+           (value < MIN_VALUE + mate_plies && value > MIN_VALUE);
+
+} // is_mate(long const value)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get a value to store for a position found at the given ply.
+//
+// A mate is worth MIN_VALUE plus the ply it happens at, counted from the root.
+// The same position can be reached again at another ply or on a later turn, so
+// the table keeps how far the mate is from the position itself instead.
+long value_to_entry(long const value, index_t const ply)
+{
+    if (!is_mate(value)) {
+        return value;
+    }
+
+    return (value > 0) ? value + ply : value - ply;
+
+} // value_to_entry(long const value, index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the value of an entry for a position found at the given ply
+long value_from_entry(long const value, index_t const ply)
+{
+    if (!is_mate(value)) {
+        return value;
+    }
+
+    return (value > 0) ? value - ply : value + ply;
+
+} // value_from_entry(long const value, index_t const ply)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get one of the Zobrist keys.
+//
+// The keys are mixed from their index on the fly (splitmix64) instead of
+// being kept in a table, so they cost no RAM or flash on the small boards.
+uint64_t zobrist(uint16_t const index)
+{
+    uint64_t z = PRN_SEED + (index + 1u) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+
+} // zobrist(uint16_t const index)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the Zobrist key for a Piece at a board location
+uint64_t zobrist_piece(Piece const piece, index_t const index)
+{
+    return zobrist(ZOB_PIECES + (getSide(piece) * 6 + getType(piece) - 1) * 64 + index);
+
+} // zobrist_piece(Piece const piece, index_t const index)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the combined Zobrist keys for a set of castling rights and an en-passant column
+uint64_t zobrist_state(uint8_t const rights, index_t const col)
+{
+    uint64_t key = 0;
+
+    for (index_t bit = 0; bit < 4; bit++) {
+        if (rights & (1 << bit)) {
+            key ^= zobrist(ZOB_CASTLE + bit);
+        }
+    }
+
+    if (-1 != col) {
+        key ^= zobrist(ZOB_EN_PASSANT + col);
+    }
+
+    return key;
+
+} // zobrist_state(uint8_t const rights, index_t const col)
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the castling rights from the 'moved' flags of the kings and rooks
+//
+// returns the rights as bits: 1 = White King side, 2 = White Queen side,
+//                             4 = Black King side, 8 = Black Queen side
+uint8_t castle_rights()
+{
+    uint8_t rights = 0;
+
+    for (index_t side = 0; side < 2; side++) {
+        index_t const row = (White == side) ? 7 : 0;
+        Piece const king = engine->board.get(4 + row * 8);
+        if (King != getType(king) || side != getSide(king) || hasMoved(king)) {
+            continue;
+        }
+
+        Piece const krook = engine->board.get(7 + row * 8);
+        Piece const qrook = engine->board.get(0 + row * 8);
+        uint8_t const shift = (White == side) ? 0 : 2;
+
+        if (Rook == getType(krook) && side == getSide(krook) && !hasMoved(krook)) {
+            rights |= 1 << shift;
+        }
+
+        if (Rook == getType(qrook) && side == getSide(qrook) && !hasMoved(qrook)) {
+            rights |= 2 << shift;
+        }
+    }
+
+    return rights;
+
+} // castle_rights()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Get the column a pawn can be taken en-passant on.
+//
+// returns the column of the pawn that just moved two spots or -1 if there is none
+index_t en_passant_col()
+{
+    if (-1 == engine->game.last_move.from || -1 == engine->game.last_move.to) {
+        return -1;
+    }
+
+    if (Pawn != getType(engine->board.get(engine->game.last_move.to))) {
+        return -1;
+    }
+
+    if (abs((engine->game.last_move.from / 8) - (engine->game.last_move.to / 8)) != 2) {
+        return -1;
+    }
+
+    return engine->game.last_move.to % 8;
+
+} // en_passant_col()
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Calculate the Zobrist hash of the board, the castling and en-passant
+// state, and the side to move from scratch.
+uint64_t hash_board(Color const side)
+{
+    uint64_t key = 0;
+
+    for (index_t index = 0; index < index_t(BOARD_SIZE); index++) {
+        Piece const piece = engine->board.get(index);
+        if (Empty == getType(piece)) { continue; }
+        key ^= zobrist_piece(piece, index);
+    }
+
+    key ^= zobrist_state(castle_rights(), en_passant_col());
+
+    if (White == side) {
+        key ^= zobrist(ZOB_SIDE);
+    }
+
+    return key;
+
+} // hash_board(Color const side)
@@ -0,0 +1,112 @@
+/**
+ * ttable.h
+ *
+ * the MicroChess project: https://github.com/ripred/MicroChess
+ *
+ * The ttable_t transposition table used to remember the results of
+ * positions that have already been searched, and the Zobrist hashing
+ * used to identify those positions.
+ *
+ */
+#ifndef TTABLE_INCL
+#define TTABLE_INCL
+
+#include <stdint.h>
+
+#ifdef ENA_SMP
+#include <atomic>
+#endif
+
+static_assert(0 == (TT_ENTRIES & (TT_ENTRIES - 1)), "TT_ENTRIES must be a power of 2");
+
+// The kind of value held in a transposition table entry
+enum bound_t : uint8_t {
+    NO_BOUND = 0,       // the entry is unused
+    EXACT_BOUND,        // the value is the value found for the position
+    LOWER_BOUND,        // the search was cut off and the value is at least this much
+    UPPER_BOUND,        // the search was cut off and the value is at most this much
+};
+
+// The offsets of each group of keys used in Zobrist hashing
+enum : uint16_t {
+    ZOB_PIECES     = 0,                 // 12 piece kinds * 64 spots
+    ZOB_CASTLE     = ZOB_PIECES + 768,  // 4 castling rights
+    ZOB_EN_PASSANT = ZOB_CASTLE + 4,    // 8 en-passant columns
+    ZOB_SIDE       = ZOB_EN_PASSANT + 8 // White to move
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+// an entry in the transposition table
+struct tt_entry_t {
+    uint32_t    lock;           // the upper 32 bits of the Zobrist key to verify a hit
+    int32_t     value;          // the value found for the position
+    uint8_t
+                from : 6,       // the best move found from the position (from == to if none)
+               bound : 2,       // one of the bound_t values
+                  to : 6;
+    int8_t      depth;          // the number of plies that were searched below the position
+    uint8_t     age;            // the game move number when the entry was stored
+
+};  // tt_entry_t
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+// the transposition table
+class ttable_t {
+    private:
+    #ifdef ENA_SMP
+    // The threads searching with Lazy SMP share the table without locking it. Each
+    // entry is packed into one word along with a word holding the Zobrist key mixed
+    // with it, so an entry that was read while another thread was storing it won't
+    // match the key it is looked up with.
+    struct shared_t {
+        std::atomic<uint64_t>   check;      // the Zobrist key xor-ed with data
+        std::atomic<uint64_t>   data;       // the packed tt_entry_t
+
+    }   entries[TT_ENTRIES];
+    #else
+    tt_entry_t  entries[TT_ENTRIES];
+    #endif
+
+    public:
+    ttable_t();
+
+    // Empty the table
+    void clear();
+
+    // Find the entry for a position or return nullptr if we haven't seen it
+    tt_entry_t const *probe(uint64_t const key) const;
+
+    // Remember the results of searching a position
+    void store(uint64_t const key, index_t const depth, bound_t const bound, long const value, move_t const &best);
+
+};  // ttable_t
+
+extern ttable_t ttable;
+
+// Get a value to store for a position found at the given ply. Mate values count
+// the plies from the root so they are changed to count them from the position.
+extern long value_to_entry(long const value, index_t const ply);
+
+// Get the value of an entry for a position found at the given ply
+extern long value_from_entry(long const value, index_t const ply);
+
+// Get one of the Zobrist keys
+extern uint64_t zobrist(uint16_t const index);
+
+// Get the Zobrist key for a Piece at a board location
+extern uint64_t zobrist_piece(Piece const piece, index_t const index);
+
+// Get the combined Zobrist keys for a set of castling rights and an en-passant column
+extern uint64_t zobrist_state(uint8_t const rights, index_t const col);
+
+// Get the castling rights as 4 bits: White King side, White Queen side, Black King side, Black Queen side
+extern uint8_t  castle_rights();
+
+// Get the column a pawn can be taken en-passant on or -1 if there is none
+extern index_t  en_passant_col();
+
+// Calculate the Zobrist hash of the board and game state from scratch
+extern uint64_t hash_board(Color const side);
+
+#endif // TTABLE_INCL